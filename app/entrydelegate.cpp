@@ -0,0 +1,142 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "entrydelegate.h"
+
+#include "entrylistmodel.h"
+
+#include <QAbstractItemView>
+#include <QAbstractTextDocumentLayout>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QTextDocument>
+#include <QtMath>
+
+// Widths the view had recently, more are seldom needed unless it is resized
+static constexpr int maximumHeightWidths = 4;
+
+EntryDelegate::EntryDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+    , _documents(200) // a few screens worth of rows
+{
+}
+
+EntryDelegate::~EntryDelegate() = default;
+
+QString EntryDelegate::anchorAt(const QStyleOptionViewItem &option, const QModelIndex &index, const QPoint &pos) const
+{
+    if (!index.isValid() || !option.rect.contains(pos)) {
+        return {};
+    }
+
+    QTextDocument *doc = document(option, index);
+    return doc->documentLayout()->anchorAt(pos - option.rect.topLeft());
+}
+
+void EntryDelegate::clearCache()
+{
+    _documents.clear();
+    _heights.clear();
+}
+
+void EntryDelegate::clearRows(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        _documents.remove(row);
+        for (QHash<int, int> &heights : _heights) {
+            heights.remove(row);
+        }
+    }
+}
+
+QTextDocument *EntryDelegate::document(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    const int width = textWidth(option);
+
+    QTextDocument *doc = _documents.object(index.row());
+    if (!doc) {
+        doc = new QTextDocument;
+        doc->setDefaultFont(option.font);
+        doc->setDefaultStyleSheet(_styleSheet);
+        doc->setHtml(index.data(EntryListModel::EntryHtmlRole).toString());
+        doc->setTextWidth(width);
+        _documents.insert(index.row(), doc);
+    } else if (doc->textWidth() != width) {
+        doc->setTextWidth(width);
+    }
+
+    return doc;
+}
+
+bool EntryDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    if (event->type() == QEvent::MouseButtonRelease) {
+        auto mouseEvent = static_cast<QMouseEvent *>(event);
+        if (mouseEvent->button() == Qt::LeftButton) {
+            const QString url = anchorAt(option, index, mouseEvent->position().toPoint());
+            if (!url.isEmpty()) {
+                Q_EMIT linkActivated(url);
+                return true;
+            }
+        }
+    }
+
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
+
+void EntryDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QTextDocument *doc = document(option, index);
+
+    painter->save();
+    painter->translate(option.rect.topLeft());
+    const QRect clip(0, 0, option.rect.width(), option.rect.height());
+    painter->setClipRect(clip);
+
+    QAbstractTextDocumentLayout::PaintContext context;
+    context.palette = option.palette;
+    context.clip = clip;
+    doc->documentLayout()->draw(painter, context);
+
+    painter->restore();
+}
+
+void EntryDelegate::setStyleSheet(const QString &styleSheet)
+{
+    if (_styleSheet != styleSheet) {
+        _styleSheet = styleSheet;
+        clearCache();
+    }
+}
+
+QSize EntryDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    const int width = textWidth(option);
+    if (!_heights.contains(width) && _heights.size() >= maximumHeightWidths) {
+        _heights.clear();
+    }
+
+    QHash<int, int> &heights = _heights[width];
+    auto height = heights.constFind(index.row());
+    if (height == heights.constEnd()) {
+        height = heights.insert(index.row(), qCeil(document(option, index)->size().height()));
+    }
+
+    return QSize(width, *height);
+}
+
+int EntryDelegate::textWidth(const QStyleOptionViewItem &option)
+{
+    // Rows always span the whole view, sizeHint() is called without a rect
+    if (auto view = qobject_cast<const QAbstractItemView *>(option.widget)) {
+        return view->viewport()->width();
+    }
+
+    return option.rect.width();
+}
+
+#include "moc_entrydelegate.cpp"
@@ -0,0 +1,65 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef ENTRYDELEGATE_H
+#define ENTRYDELEGATE_H
+
+#include <QCache>
+#include <QHash>
+#include <QStyledItemDelegate>
+
+class QTextDocument;
+
+/**
+ * Draws one search result per row from the HTML given by
+ * EntryListModel::EntryHtmlRole. Only the rows the view asks for are laid
+ * out, and their documents are kept in a small cache for repaints. The
+ * heights of the rows are kept apart from the documents, for every row and
+ * a few widths, so laying out the view again does not parse every row.
+ */
+class EntryDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit EntryDelegate(QObject *parent = nullptr);
+    ~EntryDelegate() override;
+
+    /**
+     * Returns the link under @p pos (in view coordinates) in the row drawn
+     * with @p option, or an empty string if there is none
+     */
+    QString anchorAt(const QStyleOptionViewItem &option, const QModelIndex &index, const QPoint &pos) const;
+    bool editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index) override;
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+public Q_SLOTS:
+    void clearCache();
+    /**
+     * Forget the documents and heights of the rows from @p topLeft to
+     * @p bottomRight, connected to QAbstractItemModel::dataChanged()
+     */
+    void clearRows(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void setStyleSheet(const QString &styleSheet);
+
+Q_SIGNALS:
+    void linkActivated(const QString &url);
+
+private:
+    QTextDocument *document(const QStyleOptionViewItem &option, const QModelIndex &index) const;
+    static int textWidth(const QStyleOptionViewItem &option);
+
+    mutable QCache<int, QTextDocument> _documents;
+    /**
+     * Text width -> row -> height of the row at that width
+     */
+    mutable QHash<int, QHash<int, int>> _heights;
+    QString _styleSheet;
+};
+
+#endif
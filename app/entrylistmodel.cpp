@@ -12,16 +12,35 @@
 
 #include "entry.h"
 
-EntryListModel::EntryListModel(const EntryList &list)
-    : _list(list)
+EntryListModel::EntryListModel(const EntryList &list, QObject *parent)
+    : QAbstractTableModel(parent)
+    , _list(list)
+    , _loadedRows(qMin<int>(list.size(), pageSize))
 {
 }
 
+bool EntryListModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && _loadedRows < _list.size();
+}
+
 EntryList EntryListModel::entryList() const
 {
     return _list;
 }
 
+void EntryListModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    const int last = qMin<int>(_list.size(), _loadedRows + pageSize) - 1;
+    beginInsertRows(QModelIndex(), _loadedRows, last);
+    _loadedRows = last + 1;
+    endInsertRows();
+}
+
 Qt::ItemFlags EntryListModel::flags(const QModelIndex &index) const
 {
     return QAbstractTableModel::flags(index) | Qt::ItemIsEditable;
@@ -29,34 +48,43 @@ Qt::ItemFlags EntryListModel::flags(const QModelIndex &index) const
 
 bool EntryListModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-    if (role == Qt::EditRole) {
-        const QString &separator = _list[index.row()]->outputListDelimiter;
+    if (role != Qt::EditRole || !index.isValid()) {
+        return false;
+    }
 
-        switch (index.column()) {
-        case 0:
-            _list[index.row()]->Word = value.toString();
-            break;
-        case 1:
-            _list[index.row()]->Readings = value.toString().split(separator);
-            break;
-        case 2:
-            _list[index.row()]->Meanings = value.toString().split(separator);
-            break;
-        }
+    // The entry may be shared with the history, edit our own copy of it
+    Entry *entry = _list.detachEntry(index.row());
+    const QString &separator = entry->outputListDelimiter;
+
+    switch (index.column()) {
+    case 0:
+        entry->Word = value.toString();
+        break;
+    case 1:
+        entry->Readings = value.toString().split(separator);
+        break;
+    case 2:
+        entry->Meanings = value.toString().split(separator);
+        break;
+    default:
+        return false;
     }
 
-    return false;
+    Q_EMIT dataChanged(index, index);
+    return true;
 }
 
 void EntryListModel::setEntryList(const EntryList &list)
 {
+    beginResetModel();
     _list = list;
-    Q_EMIT layoutChanged();
+    _loadedRows = qMin<int>(_list.size(), pageSize);
+    endResetModel();
 }
 
 int EntryListModel::rowCount(const QModelIndex &parent) const
 {
-    return parent.isValid() ? 0 : _list.size();
+    return parent.isValid() ? 0 : _loadedRows;
 }
 
 int EntryListModel::columnCount(const QModelIndex &parent) const
@@ -85,6 +113,13 @@ QVariant EntryListModel::data(const QModelIndex &index, int role) const
 
         break;
     }
+    case EntryHtmlRole:
+        if (index.isValid() && index.row() < _loadedRows) {
+            QString html;
+            _list.appendHTML(html, index.row(), 1);
+            return html;
+        }
+        break;
     }
 
     return {};
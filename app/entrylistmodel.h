@@ -20,18 +20,33 @@ class EntryListModel : public QAbstractTableModel
     Q_OBJECT
 
 public:
-    explicit EntryListModel(const EntryList &list);
+    enum Roles {
+        /**
+         * The HTML of a single entry, with the headers that come before it
+         */
+        EntryHtmlRole = Qt::UserRole + 1
+    };
 
+    explicit EntryListModel(const EntryList &list, QObject *parent = nullptr);
+
+    bool canFetchMore(const QModelIndex &parent) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     EntryList entryList() const;
+    void fetchMore(const QModelIndex &parent) override;
     Qt::ItemFlags flags(const QModelIndex &index) const override;
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
     void setEntryList(const EntryList &list);
 
 private:
+    /**
+     * Rows are handed to views a page at a time, as they scroll down
+     */
+    static constexpr int pageSize = 100;
+
     EntryList _list;
+    int _loadedRows = 0;
 };
 
 #endif
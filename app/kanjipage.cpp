@@ -9,14 +9,19 @@
 
 #include "DictKanjidic/entrykanjidic.h"
 #include "dictionarymanager.h"
-#include "dictquery.h"
 #include "entrylist.h"
+#include "kanjisimilarity.h"
 #include "kitenconfig.h"
+#include "kitenmacros.h"
+#include "stylesheetcache.h"
 
 #include <KColorScheme>
 #include <KLocalizedString>
 
+#include <QEvent>
+#include <QStandardPaths>
 #include <QTextBrowser>
+#include <QTextDocument>
 #include <QUrl>
 #include <QVBoxLayout>
 
@@ -33,39 +38,41 @@ KanjiPage::KanjiPage(QWidget *parent)
     _browser->setOpenLinks(false);
     _browser->setOpenExternalLinks(false);
     connect(_browser, &QTextBrowser::anchorClicked, this, &KanjiPage::handleLinkClicked);
+    connect(StyleSheetCache::self(), &StyleSheetCache::invalidated, this, &KanjiPage::updateStyleSheet);
+    updateStyleSheet();
 }
 
-QChar KanjiPage::currentKanji() const
+void KanjiPage::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::PaletteChange || event->type() == QEvent::FontChange) {
+        StyleSheetCache::self()->scheduleInvalidate();
+    }
+
+    QWidget::changeEvent(event);
+}
+
+char32_t KanjiPage::currentKanji() const
 {
     return _currentKanji;
 }
 
-void KanjiPage::setKanji(const QChar &kanji, DictionaryManager *dictManager)
+void KanjiPage::setKanji(char32_t kanji, DictionaryManager *dictManager)
 {
     _currentKanji = kanji;
+    const QString kanjiText = QString::fromUcs4(&kanji, 1);
 
-    // Search KANJIDIC for this kanji
-    DictQuery kanjiQuery{QString{kanji}};
-    EntryList *kanjiResults = dictManager->doSearch(kanjiQuery);
-
-    // Find the EntryKanjidic entry
-    EntryKanjidic *kanjiEntry = nullptr;
-    for (int i = 0; i < kanjiResults->count(); ++i) {
-        auto entry = dynamic_cast<EntryKanjidic *>(kanjiResults->at(i));
-        if (entry) {
-            kanjiEntry = entry;
-            break;
-        }
-    }
+    // Look this kanji up in KANJIDIC
+    EntryList *kanjiResults = dictManager->lookupKanji(kanji);
+    auto kanjiEntry = kanjiResults->isEmpty() ? nullptr : static_cast<EntryKanjidic *>(kanjiResults->first());
 
     QString html;
-    html += QStringLiteral("<html><head><style>%1</style></head><body>").arg(generateCSS());
+    html += QStringLiteral("<html><body>");
 
     if (kanjiEntry) {
         // Large kanji character header
         html += QStringLiteral("<div class=\"kanji-header\">"
                                "<span class=\"kanji-char\">%1</span>")
-                    .arg(kanji);
+                    .arg(kanjiText);
 
         // Metadata: grade and strokes
         html += QStringLiteral("<span class=\"kanji-meta\">");
@@ -87,17 +94,17 @@ void KanjiPage::setKanji(const QChar &kanji, DictionaryManager *dictManager)
 
         if (!kanjiEntry->getOnyomiReadingsList().isEmpty()) {
             html += QStringLiteral("<p class=\"label\">%1 <span class=\"reading\">%2</span></p>")
-                        .arg(i18n("Onyomi:"), kanjiEntry->getOnyomiReadings());
+                        .arg(i18n("Onyomi:"), readingLinks(kanjiEntry->getOnyomiReadingsList()));
         }
 
         if (!kanjiEntry->getKunyomiReadingsList().isEmpty()) {
             html += QStringLiteral("<p class=\"label\">%1 <span class=\"reading\">%2</span></p>")
-                        .arg(i18n("Kunyomi:"), kanjiEntry->getKunyomiReadings());
+                        .arg(i18n("Kunyomi:"), readingLinks(kanjiEntry->getKunyomiReadingsList()));
         }
 
         if (!kanjiEntry->getInNamesReadingsList().isEmpty()) {
             html += QStringLiteral("<p class=\"label\">%1 <span class=\"reading\">%2</span></p>")
-                        .arg(i18n("In names:"), kanjiEntry->getInNamesReadings());
+                        .arg(i18n("In names:"), readingLinks(kanjiEntry->getInNamesReadingsList()));
         }
 
         if (!kanjiEntry->getAsRadicalReadingsList().isEmpty()) {
@@ -121,63 +128,53 @@ void KanjiPage::setKanji(const QChar &kanji, DictionaryManager *dictManager)
                                "<span class=\"kanji-char\">%1</span>"
                                "<span class=\"kanji-meta\"><br>%2</span>"
                                "</div>")
-                    .arg(kanji)
+                    .arg(kanjiText)
                     .arg(i18n("No kanji dictionary entry found"));
     }
 
-    // Compounds section: search EDICT for words containing this kanji
-    DictQuery compoundQuery{QString{kanji}};
-    compoundQuery.setMatchType(DictQuery::Anywhere);
-    EntryList *compoundResults = dictManager->doSearch(compoundQuery);
+    // Similar kanji section: kanji built from mostly the same radicals, for
+    // telling lookalikes apart
+    const QStringList kanjidicNames = dictManager->listDictionariesOfType(KANJIDIC);
+    const QString kanjidic = kanjidicNames.isEmpty() ? QString() : dictManager->listDictionaryInfo(kanjidicNames.first()).second;
+    const QString radkfile = QStandardPaths::locate(QStandardPaths::GenericDataLocation, QStringLiteral("kiten/radkfile"));
+    const KanjiSimilarity::Pointer similarity = radkfile.isEmpty() ? KanjiSimilarity::Pointer() : KanjiSimilarity::load(radkfile, kanjidic);
+    if (similarity) {
+        const QList<KanjiSimilarity::Match> similar = similarity->similarKanji(kanji, similarLimit, similarStrokeWeight);
+        if (!similar.isEmpty()) {
+            html += QStringLiteral("<div class=\"section\">"
+                                   "<p class=\"section-title\">%1</p>"
+                                   "<p class=\"similar\">")
+                        .arg(i18n("Similar Kanji"));
+            for (const KanjiSimilarity::Match &match : similar) {
+                const QString similarKanji = QString::fromUcs4(&match.kanji, 1);
+                html += QStringLiteral("<a href=\"kanji:%1\">%1</a> ").arg(similarKanji);
+            }
+            html += QStringLiteral("</p></div>");
+        }
+    }
+
+    // Compounds section: EDICT words containing this kanji, from the index
+    // built while loading, common words first
+    int compoundTotal = 0;
+    EntryList *compoundResults = dictManager->compoundsForKanji(kanji, compoundLimit, &compoundTotal);
 
-    if (compoundResults && compoundResults->count() > 0) {
+    if (compoundResults->count() > 0) {
         html += QStringLiteral("<div class=\"section\">"
                                "<p class=\"section-title\">%1</p>")
                     .arg(i18n("Compound Words"));
 
-        // Collect non-kanjidic entries (edict words)
-        struct CompoundInfo {
-            QString word;
-            QString reading;
-            QString meaning;
-            bool isCommon;
-        };
-        QList<CompoundInfo> compounds;
-
-        for (int i = 0; i < compoundResults->count(); ++i) {
-            Entry *entry = compoundResults->at(i);
-            // Skip kanjidic entries (we only want word entries)
-            if (dynamic_cast<EntryKanjidic *>(entry)) {
-                continue;
-            }
-            CompoundInfo info;
-            info.word = entry->getWord();
-            info.reading = entry->getReadings();
-            info.meaning = entry->getMeanings();
-            info.isCommon = entry->extendedItemCheck(QStringLiteral("common"), QStringLiteral("1"));
-            compounds.append(info);
-        }
-
-        // Sort: common words first, then alphabetical
-        std::sort(compounds.begin(), compounds.end(), [](const CompoundInfo &a, const CompoundInfo &b) {
-            if (a.isCommon != b.isCommon) {
-                return a.isCommon;
-            }
-            return a.word < b.word;
-        });
-
-        // Limit to a reasonable number
-        int limit = qMin(compounds.count(), 50);
-        for (int i = 0; i < limit; ++i) {
-            const auto &comp = compounds.at(i);
+        for (const Entry *entry : std::as_const(*compoundResults)) {
+            const QString word = entry->getWord();
+            const QString reading = entry->getReadings();
+            const bool isCommon = entry->extendedItemCheck(QStringLiteral("common"), QStringLiteral("1"));
 
             // Link the whole compound word to the word page
             QString wordLink = QStringLiteral("<a href=\"word:%1:%2\">%1</a>")
-                                   .arg(comp.word, comp.reading);
+                                   .arg(word, reading);
 
-            QString commonMark = comp.isCommon ? QStringLiteral(" <span class=\"common-tag\">%1</span>").arg(i18n("common")) : QString();
+            QString commonMark = isCommon ? QStringLiteral(" <span class=\"common-tag\">%1</span>").arg(i18n("common")) : QString();
 
-            QString meaningShort = comp.meaning;
+            QString meaningShort = entry->getMeanings();
             // Truncate long meanings
             if (meaningShort.length() > 80) {
                 meaningShort = meaningShort.left(77) + QStringLiteral("...");
@@ -188,12 +185,12 @@ void KanjiPage::setKanji(const QChar &kanji, DictionaryManager *dictManager)
                                    " <span class=\"compound-reading\">(%3)</span>"
                                    " <span class=\"compound-meaning\">%4</span>"
                                    "</div>")
-                        .arg(wordLink, commonMark, comp.reading, meaningShort);
+                        .arg(wordLink, commonMark, reading, meaningShort);
         }
 
-        if (compounds.count() > limit) {
+        if (compoundTotal > compoundResults->count()) {
             html += QStringLiteral("<p class=\"more\">%1</p>")
-                        .arg(i18n("...and %1 more", compounds.count() - limit));
+                        .arg(i18n("...and %1 more", compoundTotal - compoundResults->count()));
         }
 
         html += QStringLiteral("</div>");
@@ -201,6 +198,7 @@ void KanjiPage::setKanji(const QChar &kanji, DictionaryManager *dictManager)
 
     html += QStringLiteral("</body></html>");
 
+    _html = html;
     _browser->setHtml(html);
 
     kanjiResults->deleteAll();
@@ -214,9 +212,14 @@ void KanjiPage::handleLinkClicked(const QUrl &url)
     QString urlStr = url.toString();
 
     if (urlStr.startsWith("kanji:"_L1)) {
-        QString kanjiStr = urlStr.mid(6);
-        if (!kanjiStr.isEmpty()) {
-            Q_EMIT kanjiClicked(kanjiStr.at(0));
+        const QList<uint> kanji = QStringView(urlStr).mid(6).toUcs4();
+        if (!kanji.isEmpty()) {
+            Q_EMIT kanjiClicked(kanji.first());
+        }
+    } else if (urlStr.startsWith("reading:"_L1)) {
+        const QString reading = urlStr.mid(8);
+        if (!reading.isEmpty()) {
+            Q_EMIT readingClicked(reading);
         }
     } else if (urlStr.startsWith("word:"_L1)) {
         // Format: word:WORD:READING
@@ -227,8 +230,23 @@ void KanjiPage::handleLinkClicked(const QUrl &url)
             QString reading = rest.mid(sep + 1);
             Q_EMIT wordClicked(word, reading);
         }
-    } else if (urlStr.length() == 1 && isCJKCharacter(urlStr.at(0))) {
-        Q_EMIT kanjiClicked(urlStr.at(0));
+    } else if (const QList<uint> kanji = urlStr.toUcs4(); kanji.size() == 1 && isCJKCharacter(kanji.first())) {
+        Q_EMIT kanjiClicked(kanji.first());
+    }
+}
+
+/**
+ * The style sheet is set on the document once, setHtml() reuses it
+ */
+void KanjiPage::updateStyleSheet()
+{
+    const QString css = StyleSheetCache::self()->styleSheet(StyleSheetCache::KanjiPageSheet, [this]() {
+        return generateCSS();
+    });
+
+    _browser->document()->setDefaultStyleSheet(css);
+    if (!_html.isEmpty()) {
+        _browser->setHtml(_html);
     }
 }
 
@@ -253,6 +271,7 @@ QString KanjiPage::generateCSS() const
                ".compound-word { font-size: %10pt; }"
                ".compound-reading { color: %8; }"
                ".compound-meaning { }"
+               ".similar { font-size: %10pt; }"
                ".common-tag { color: %11; font-size: 8pt; font-weight: bold; }"
                ".more { color: %8; font-style: italic; }")
         .arg(scheme.background(KColorScheme::NormalBackground).color().name())   // %1
@@ -268,9 +287,18 @@ QString KanjiPage::generateCSS() const
         .arg(scheme.foreground(KColorScheme::PositiveText).color().name());       // %11
 }
 
-bool KanjiPage::isCJKCharacter(const QChar &ch)
+QString KanjiPage::readingLinks(const QStringList &readings)
+{
+    QStringList links;
+    links.reserve(readings.size());
+    for (const QString &reading : readings) {
+        links.append(QStringLiteral("<a href=\"reading:%1\">%1</a>").arg(reading));
+    }
+    return links.join(i18nc("@item:intext separator between the readings of a kanji", "; "));
+}
+
+bool KanjiPage::isCJKCharacter(char32_t value)
 {
-    ushort value = ch.unicode();
     if (value < 255) {
         return false;
     }
@@ -20,22 +20,54 @@ class KanjiPage : public QWidget
 public:
     explicit KanjiPage(QWidget *parent = nullptr);
 
-    void setKanji(const QChar &kanji, DictionaryManager *dictManager);
-    QChar currentKanji() const;
+    /**
+     * Show the kanji with the code point @p kanji
+     */
+    void setKanji(char32_t kanji, DictionaryManager *dictManager);
+    char32_t currentKanji() const;
 
 Q_SIGNALS:
-    void kanjiClicked(const QChar &kanji);
+    void kanjiClicked(char32_t kanji);
     void wordClicked(const QString &word, const QString &reading);
+    /**
+     * A reading was clicked, to list every kanji read that way
+     */
+    void readingClicked(const QString &reading);
+
+protected:
+    void changeEvent(QEvent *event) override;
 
 private Q_SLOTS:
     void handleLinkClicked(const QUrl &url);
+    void updateStyleSheet();
 
 private:
+    /**
+     * The number of compound words listed below the kanji
+     */
+    static constexpr int compoundLimit = 50;
+    /**
+     * The number of similar looking kanji listed below the meanings
+     */
+    static constexpr int similarLimit = 12;
+    /**
+     * How much a difference in strokes lowers the similarity of two kanji
+     */
+    static constexpr float similarStrokeWeight = 0.1f;
+
     QString generateCSS() const;
-    static bool isCJKCharacter(const QChar &ch);
+    /**
+     * @p readings as links to the kanji with the same reading
+     */
+    static QString readingLinks(const QStringList &readings);
+    static bool isCJKCharacter(char32_t value);
 
     QTextBrowser *_browser;
-    QChar _currentKanji;
+    /**
+     * The last page shown, without the style sheet
+     */
+    QString _html;
+    char32_t _currentKanji = 0;
 };
 
 #endif
@@ -15,7 +15,6 @@
 #include <KConfigGui>
 #include <KEditToolBar>
 #include <KLocalizedString>
-#include <KProcess>
 #include <KStandardAction>
 #include <KStandardGuiItem>
 #include <KToggleAction>
@@ -32,18 +31,24 @@
 #include <QStandardPaths>
 #include <QStatusBar>
 #include <QTimer>
+#include <QToolBar>
 #include <QVBoxLayout>
 
 #include "configuredialog.h"
 #include "dictionaryupdatemanager.h"
+#include "entryarena.h"
 #include "entrylist.h"
 #include "entrylistmodel.h"
 #include "entrylistview.h"
+#include "kanjibrowserview.h"
 #include "kanjipage.h"
 #include "kitenconfig.h"
+#include "kitenmacros.h"
+#include "radselectview.h"
 #include "resultsview.h"
 #include "searchresultspage.h"
 #include "searchstringinput.h"
+#include "stylesheetcache.h"
 #include "wordpage.h"
 
 using namespace Qt::StringLiterals;
@@ -51,11 +56,7 @@ using namespace Qt::StringLiterals;
 Kiten::Kiten(QWidget *parent, const char *name)
     : KXmlGuiWindow(parent)
     , _lastQuery(DictQuery())
-    , _radselect_proc(new KProcess(this))
-    , _kanjibrowser_proc(new KProcess(this))
 {
-    _radselect_proc->setProgram(QStandardPaths::findExecutable(QStringLiteral("kitenradselect")));
-    _kanjibrowser_proc->setProgram(QStandardPaths::findExecutable(QStringLiteral("kitenkanjibrowser")));
     setStandardToolBarMenuEnabled(true);
     setObjectName(QLatin1String(name));
 
@@ -63,6 +64,9 @@ Kiten::Kiten(QWidget *parent, const char *name)
     _config = KitenConfigSkeleton::self();
     _config->load();
 
+    /* Old history items are loaded back from their dictionaries when needed */
+    _historyList.setDictionaryManager(&_dictionaryManager);
+
     /* Set up the page stack with three pages */
     _pageStack = new QStackedWidget(this);
 
@@ -106,6 +110,7 @@ Kiten::Kiten(QWidget *parent, const char *name)
     /* Connect KanjiPage signals */
     connect(_kanjiPage, &KanjiPage::kanjiClicked, this, &Kiten::navigateToKanji);
     connect(_kanjiPage, &KanjiPage::wordClicked, this, &Kiten::navigateToWord);
+    connect(_kanjiPage, &KanjiPage::readingClicked, this, &Kiten::searchKanjiReading);
 
     /* Connect WordPage signals */
     connect(_wordPage, &WordPage::kanjiClicked, this, &Kiten::navigateToKanji);
@@ -124,12 +129,9 @@ Kiten::Kiten(QWidget *parent, const char *name)
 // Destructor to clean up the little bits
 Kiten::~Kiten()
 {
-    if (_radselect_proc->state() != QProcess::NotRunning) {
-        _radselect_proc->kill();
-    }
-    if (_kanjibrowser_proc->state() != QProcess::NotRunning) {
-        _kanjibrowser_proc->kill();
-    }
+    // The kanji browser looks kanji up in our dictionaries
+    delete _kanjiBrowserDock;
+    _kanjiBrowserDock = nullptr;
     _dictionaryManager.removeAllDictionaries();
     delete _optionDialog;
     _optionDialog = nullptr;
@@ -228,7 +230,7 @@ void Kiten::addExportListEntry(int index)
 
     EntryList list = model->entryList();
 
-    list << _historyList.current()->at(index)->clone();
+    list << list.arena()->adopt(_historyList.current()->at(index)->clone());
     model->setEntryList(list);
 }
 
@@ -297,6 +299,19 @@ void Kiten::searchText(const QString &text)
     searchAndDisplay(DictQuery(text));
 }
 
+/**
+ * Lists every kanji with this reading, as clicked on the kanji page. The
+ * kanji dictionaries find it in their reading index, whatever kana it is
+ * written in.
+ */
+void Kiten::searchKanjiReading(const QString &reading)
+{
+    DictQuery query;
+    query.setPronunciation(reading);
+    query.setDictionaries(_dictionaryManager.listDictionariesOfType(KANJIDIC));
+    searchAndDisplay(query);
+}
+
 /**
  * This should change the Edit text to be appropriate and then begin a search
  * of the dictionaries' entries.
@@ -446,7 +461,7 @@ void Kiten::displayResults(EntryList *results)
             dictSort = _config->dictionary_sortlist();
         }
         results->sort(fieldSort, dictSort);
-        view->setContents(results->toHTML());
+        view->setResults(*results);
     } else {
         view->setContents("<html><body>"_L1 + infoStr + "</body></html>"_L1);
     }
@@ -459,31 +474,86 @@ void Kiten::displayResults(EntryList *results)
 
 void Kiten::radicalSearch()
 {
-    // Radselect is a KUniqueApplication, so we don't
-    // need to worry about opening more than one copy
-    _radselect_proc->start();
+    if (!_radselectDock) {
+        _radselectDock = new QDockWidget(i18n("Radical Selector"), this);
+        _radselectDock->setObjectName(QStringLiteral("radselectdock"));
+        // Take the number of strokes from our KANJIDIC, so that without an up
+        // to date cache the selector shares the KanjiTable we already parsed
+        QString kanjidic;
+        const QStringList kanjiDictionaries = _dictionaryManager.listDictionariesOfType(KANJIDIC);
+        if (!kanjiDictionaries.isEmpty()) {
+            kanjidic = _dictionaryManager.listDictionaryInfo(kanjiDictionaries.first()).second;
+        }
+        auto view = new RadSelectView(_radselectDock, kanjidic);
+        _radselectDock->setWidget(view);
+        addDockWidget(Qt::LeftDockWidgetArea, _radselectDock);
+
+        connect(view, &RadSelectView::signalChangeStatusbar, _statusBar, [this](const QString &text) {
+            _statusBar->showMessage(text);
+        });
+        connect(view, &RadSelectView::kanjiSelected, this, [this](const QStringList &kanji) {
+            if (!kanji.isEmpty()) {
+                searchText(kanji.first());
+            }
+        });
+    }
+
+    _radselectDock->show();
+    _radselectDock->raise();
 }
 
 void Kiten::kanjiBrowserSearch()
 {
-    // KanjiBrowser is a KUniqueApplication, so we don't
-    // need to worry about opening more than one copy
-    _kanjibrowser_proc->start();
+    if (!_kanjiBrowserDock) {
+        _kanjiBrowserDock = new QDockWidget(i18n("Kanji Browser"), this);
+        _kanjiBrowserDock->setObjectName(QStringLiteral("kanjibrowserdock"));
+        auto contents = new QWidget(_kanjiBrowserDock);
+        _kanjiBrowserDock->setWidget(contents);
+        addDockWidget(Qt::LeftDockWidgetArea, _kanjiBrowserDock);
+
+        // The view's actions get their own collection and toolbar, as their
+        // names would clash with ours
+        auto actions = new KActionCollection(contents, QStringLiteral("kanjibrowser"));
+        auto toolBar = new QToolBar(contents);
+        auto view = new KanjiBrowserView(contents);
+        view->setupView(actions, &_dictionaryManager);
+        toolBar->addActions(actions->actions());
+        actions->addAssociatedWidget(contents);
+
+        auto layout = new QVBoxLayout(contents);
+        layout->setContentsMargins(0, 0, 0, 0);
+        layout->addWidget(toolBar);
+        layout->addWidget(view);
+
+        connect(view, &KanjiBrowserView::statusBarChanged, _statusBar, [this](const QString &text) {
+            _statusBar->showMessage(text);
+        });
+        connect(view, &KanjiBrowserView::kanjiSelected, this, [this](const QString &kanji) {
+            const QList<uint> codePoints = kanji.toUcs4();
+            if (!codePoints.isEmpty()) {
+                navigateToKanji(codePoints.first());
+            }
+        });
+    }
+
+    _kanjiBrowserDock->show();
+    _kanjiBrowserDock->raise();
 }
 
 //////////////////////////////////////////////////////////////////////////////
 // NAVIGATION METHODS
 //////////////////////////////////////////////////////////////////////////////
 
-void Kiten::navigateToKanji(const QChar &kanji)
+void Kiten::navigateToKanji(char32_t kanji)
 {
+    const QString kanjiText = QString::fromUcs4(&kanji, 1);
     _kanjiPage->setKanji(kanji, &_dictionaryManager);
     _pageStack->setCurrentWidget(_kanjiPage);
-    _statusBar->showMessage(i18n("Kanji: %1", QString(kanji)));
-    setCaption(i18n("Kanji: %1", QString(kanji)));
+    _statusBar->showMessage(i18n("Kanji: %1", kanjiText));
+    setCaption(i18n("Kanji: %1", kanjiText));
 
     if (!_navigatingHistory) {
-        pushPageState({PageType::Kanji, QVariant(kanji)});
+        pushPageState({PageType::Kanji, QVariant(uint(kanji))});
     }
     enableHistoryButtons();
 }
@@ -562,6 +632,7 @@ void Kiten::updateConfiguration()
     loadDictionaries();
 
     // Update the HTML/CSS for our fonts
+    StyleSheetCache::self()->invalidate();
     displayHistoryItem();
 
     _inputManager->updateFontFromConfig();
@@ -695,8 +766,7 @@ void Kiten::back()
             displayHistoryItem();
             break;
         case PageType::Kanji: {
-            QChar kanji = state.data.toChar();
-            navigateToKanji(kanji);
+            navigateToKanji(state.data.toUInt());
             break;
         }
         case PageType::Word: {
@@ -730,8 +800,7 @@ void Kiten::forward()
             displayHistoryItem();
             break;
         case PageType::Kanji: {
-            QChar kanji = state.data.toChar();
-            navigateToKanji(kanji);
+            navigateToKanji(state.data.toUInt());
             break;
         }
         case PageType::Word: {
@@ -23,7 +23,6 @@
 #include "historyptrlist.h"
 
 class QAction;
-class KProcess;
 class QStackedWidget;
 class QStatusBar;
 class KToggleAction;
@@ -67,6 +66,7 @@ private Q_SLOTS:
     // Searching related methods
     void searchFromEdit();
     void searchText(const QString &);
+    void searchKanjiReading(const QString &reading);
     void searchClipboard();
     void searchAndDisplay(const DictQuery &);
     void searchInResults();
@@ -75,7 +75,7 @@ private Q_SLOTS:
     void kanjiBrowserSearch();
 
     // Navigation slots for kanji/word pages
-    void navigateToKanji(const QChar &kanji);
+    void navigateToKanji(char32_t kanji);
     void navigateToWord(const QString &word, const QString &reading);
     void showSearchResults();
 
@@ -109,7 +109,7 @@ private:
 
     struct PageState {
         PageType type;
-        QVariant data; // QChar for Kanji, QStringList{word,reading} for Word
+        QVariant data; // Code point (uint) for Kanji, QStringList{word,reading} for Word
     };
 
     void pushPageState(const PageState &state);
@@ -135,8 +135,10 @@ private:
     QAction *_irAction = nullptr;
     QAction *_backAction = nullptr;
     QAction *_forwardAction = nullptr;
-    KProcess *_radselect_proc = nullptr;
-    KProcess *_kanjibrowser_proc = nullptr;
+
+    // The radical selector and kanji browser, created when first used
+    QDockWidget *_radselectDock = nullptr;
+    QDockWidget *_kanjiBrowserDock = nullptr;
 
     // Export list related:
     QDockWidget *_exportListDock = nullptr;
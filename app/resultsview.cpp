@@ -9,21 +9,56 @@
 */
 
 #include "resultsview.h"
+#include "entrydelegate.h"
+#include "entrylist.h"
+#include "entrylistmodel.h"
 #include "kitenconfig.h"
+#include "stylesheetcache.h"
 #include <KColorScheme>
+#include <KLocalizedString>
+#include <QAbstractTextDocumentLayout>
+#include <QApplication>
+#include <QClipboard>
+#include <QContextMenuEvent>
+#include <QKeyEvent>
+#include <QMenu>
+#include <QMimeData>
+#include <QMouseEvent>
+#include <QPainter>
 #include <QScrollBar>
+#include <QTextDocument>
+#include <QTextDocumentFragment>
 
 ResultsView::ResultsView(QWidget *parent, const char *name)
-    : QTextBrowser(parent)
+    : QListView(parent)
+    , _delegate(new EntryDelegate(this))
+    , _message(new QTextDocument(this))
+    , _model(new EntryListModel(EntryList(), this))
     , _scrollValue(0)
 {
     Q_UNUSED(name)
-    setOpenLinks(false);
-    connect(this, &QTextBrowser::anchorClicked, this, [=](const QUrl &url) {
-        Q_EMIT urlClicked(url.toString());
-    });
+    setModel(_model);
+    setItemDelegate(_delegate);
+
+    // Rows have different heights and are only laid out as they are needed
+    setLayoutMode(QListView::Batched);
+    setResizeMode(QListView::Adjust);
+    setUniformItemSizes(false);
+    setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setSelectionMode(QAbstractItemView::NoSelection);
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+    setMouseTracking(true);
+
+    connect(_model, &QAbstractItemModel::modelReset, _delegate, &EntryDelegate::clearCache);
+    connect(_model, &QAbstractItemModel::dataChanged, _delegate, &EntryDelegate::clearRows);
+    connect(_delegate, &EntryDelegate::linkActivated, this, &ResultsView::urlClicked);
+    connect(StyleSheetCache::self(), &StyleSheetCache::invalidated, this, &ResultsView::updateStyleSheet);
+    updateStyleSheet();
 }
 
+ResultsView::~ResultsView() = default;
+
 /**
  * As the name implies, it appends @param text to the printText
  */
@@ -40,6 +75,63 @@ void ResultsView::clear()
     _printText.clear();
 }
 
+void ResultsView::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::PaletteChange || event->type() == QEvent::FontChange) {
+        StyleSheetCache::self()->scheduleInvalidate();
+    }
+
+    QListView::changeEvent(event);
+}
+
+void ResultsView::contextMenuEvent(QContextMenuEvent *event)
+{
+    const QModelIndex index = indexAt(event->pos());
+
+    QMenu menu(this);
+    QAction *copyEntryAction = menu.addAction(QIcon::fromTheme(QStringLiteral("edit-copy")), i18n("&Copy Entry"));
+    copyEntryAction->setEnabled(index.isValid());
+    QAction *copyAllAction = menu.addAction(i18n("Copy &All Results"));
+    copyAllAction->setEnabled(!_model->entryList().isEmpty() || !_message->isEmpty());
+
+    QAction *chosen = menu.exec(event->globalPos());
+    if (chosen == copyEntryAction) {
+        copyEntry(index);
+    } else if (chosen == copyAllAction) {
+        copyAll();
+    }
+}
+
+void ResultsView::copyAll()
+{
+    // The model only holds the pages fetched so far, the list has every
+    // result, along with the dictionary and Common/Uncommon headers
+    const EntryList results = _model->entryList();
+    if (results.isEmpty()) {
+        if (!_message->isEmpty()) {
+            copyHtml(_messageText);
+        }
+        return;
+    }
+
+    copyHtml(results.toHTML());
+}
+
+void ResultsView::copyEntry(const QModelIndex &index)
+{
+    if (index.isValid()) {
+        copyHtml(index.data(EntryListModel::EntryHtmlRole).toString());
+    }
+}
+
+void ResultsView::copyHtml(const QString &html)
+{
+    auto data = new QMimeData;
+    data->setHtml(html);
+    data->setText(QTextDocumentFragment::fromHtml(html).toPlainText());
+    QApplication::clipboard()->setMimeData(data);
+}
+
 void ResultsView::doScroll()
 {
     verticalScrollBar()->setValue(_scrollValue);
@@ -50,8 +142,7 @@ void ResultsView::doScroll()
  */
 void ResultsView::flush()
 {
-    const QString content = QStringLiteral("<head><style>%1</style></head><body>%2</body>").arg(generateCSS()).arg(_printText);
-    setHtml(content);
+    setContents(_printText);
 }
 
 QString ResultsView::generateCSS()
@@ -146,19 +237,103 @@ void ResultsView::print(const QString &title)
   */
 }
 
+void ResultsView::keyPressEvent(QKeyEvent *event)
+{
+    if (event == QKeySequence::Copy) {
+        copyEntry(currentIndex());
+        event->accept();
+        return;
+    }
+
+    QListView::keyPressEvent(event);
+}
+
+void ResultsView::mouseMoveEvent(QMouseEvent *event)
+{
+    QListView::mouseMoveEvent(event);
+
+    const QPoint pos = event->position().toPoint();
+    const QModelIndex index = indexAt(pos);
+    QString anchor;
+    if (index.isValid()) {
+        QStyleOptionViewItem option;
+        initViewItemOption(&option);
+        option.rect = visualRect(index);
+        anchor = _delegate->anchorAt(option, index, pos);
+    } else if (_model->rowCount() == 0) {
+        anchor = _message->documentLayout()->anchorAt(pos);
+    }
+
+    viewport()->setCursor(anchor.isEmpty() ? Qt::ArrowCursor : Qt::PointingHandCursor);
+}
+
+void ResultsView::paintEvent(QPaintEvent *event)
+{
+    QListView::paintEvent(event);
+
+    if (_model->rowCount() > 0 || _message->isEmpty()) {
+        return;
+    }
+
+    QPainter painter(viewport());
+    QAbstractTextDocumentLayout::PaintContext context;
+    context.palette = palette();
+    context.clip = viewport()->rect();
+    _message->documentLayout()->draw(&painter, context);
+}
+
+void ResultsView::resizeEvent(QResizeEvent *event)
+{
+    QListView::resizeEvent(event);
+    _message->setTextWidth(viewport()->width());
+}
+
 void ResultsView::setBasicMode(bool yes)
 {
     _basicMode = yes;
 }
 
 /**
- * Non-buffered write of contents to screen
+ * Non-buffered write of contents to screen. This replaces the results
+ * with a single message.
  */
 void ResultsView::setContents(const QString &text)
 {
-    const QString content = QStringLiteral("<head><style>%1</style></head><body>%2</body>").arg(generateCSS()).arg(text);
-    setHtml(content);
-    //  qDebug() << "Set HTML to " << content;
+    _model->setEntryList(EntryList());
+    _messageText = text;
+    _message->setDefaultFont(font());
+    _message->setHtml(text);
+    _message->setTextWidth(viewport()->width());
+    viewport()->update();
+}
+
+void ResultsView::setResults(const EntryList &results)
+{
+    _messageText.clear();
+    _message->clear();
+    _model->setEntryList(results);
+    scrollToTop();
+}
+
+/**
+ * Give the cached style sheet to the delegate and the message document,
+ * called once at startup and whenever the cache was invalidated
+ */
+void ResultsView::updateStyleSheet()
+{
+    const QString css = StyleSheetCache::self()->styleSheet(StyleSheetCache::ResultsSheet, [this]() {
+        return generateCSS();
+    });
+
+    _delegate->setStyleSheet(css);
+    _message->setDefaultStyleSheet(css);
+    if (!_messageText.isEmpty()) {
+        _message->setHtml(_messageText);
+        _message->setTextWidth(viewport()->width());
+    }
+    // Fonts in the sheet change the height of the rows
+    scheduleDelayedItemsLayout();
+    viewport()->update();
 }
 
 void ResultsView::setLaterScrollValue(int scrollValue)
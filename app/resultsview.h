@@ -11,25 +11,51 @@
 #define RESULTSVIEW_H
 
 #include <QAction>
-#include <QTextBrowser>
+#include <QListView>
 
 #include "entry.h"
 
+class EntryDelegate;
+class EntryList;
+class EntryListModel;
 class KActionCollection;
 class KActionMenu;
+class QTextDocument;
 
-class ResultsView : public QTextBrowser
+/**
+ * Shows search results one entry per row. Rows are drawn by EntryDelegate
+ * as they scroll into view, so the size of the result set does not matter
+ * for how fast it is displayed. The model only hands out the first page of
+ * results, further pages are fetched as the view is scrolled to the bottom.
+ * When there are no results a plain message set with setContents() is shown
+ * instead. Rows can not be selected, the context menu and the copy shortcut
+ * copy whole entries instead.
+ */
+class ResultsView : public QListView
 {
     Q_OBJECT
 
 public:
     explicit ResultsView(QWidget *parent = nullptr, const char *name = nullptr);
+    ~ResultsView() override;
 
     void setLaterScrollValue(int scrollValue);
+    /**
+     * Display @p results, replacing whatever was shown before
+     */
+    void setResults(const EntryList &results);
 
 public Q_SLOTS:
     void append(const QString &text);
     void clear();
+    /**
+     * Copy every result, with its headers, or the message to the clipboard
+     */
+    void copyAll();
+    /**
+     * Copy the entry of @p index to the clipboard
+     */
+    void copyEntry(const QModelIndex &index);
     void flush();
     void print(const QString &title);
     void setBasicMode(bool yes);
@@ -40,14 +66,30 @@ Q_SIGNALS:
     void urlClicked(const QString &);
 
 protected:
+    void changeEvent(QEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
     QString generateCSS();
+    void keyPressEvent(QKeyEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
 
 private Q_SLOTS:
     void doScroll();
+    void updateStyleSheet();
 
 private:
+    /**
+     * Put the HTML of rows, and the same as plain text, on the clipboard
+     */
+    static void copyHtml(const QString &html);
+
     QAction *_addToExportListAction = nullptr;
     bool _basicMode;
+    EntryDelegate *_delegate = nullptr;
+    QTextDocument *_message = nullptr;
+    QString _messageText;
+    EntryListModel *_model = nullptr;
     KActionCollection *_popupActions = nullptr;
     KActionMenu *_popupMenu = nullptr;
     QString _printText;
@@ -30,16 +30,16 @@ ResultsView *SearchResultsPage::resultsView() const
 void SearchResultsPage::handleUrlClicked(const QString &url)
 {
     // A single CJK character link means the user clicked a kanji
-    if (url.length() == 1 && isCJKCharacter(url.at(0))) {
-        Q_EMIT kanjiClicked(url.at(0));
+    const QList<uint> kanji = url.toUcs4();
+    if (kanji.size() == 1 && isCJKCharacter(kanji.first())) {
+        Q_EMIT kanjiClicked(kanji.first());
     } else {
         Q_EMIT wordSearchRequested(url);
     }
 }
 
-bool SearchResultsPage::isCJKCharacter(const QChar &ch)
+bool SearchResultsPage::isCJKCharacter(char32_t value)
 {
-    ushort value = ch.unicode();
     if (value < 255) {
         return false;
     }
@@ -22,7 +22,7 @@ public:
     ResultsView *resultsView() const;
 
 Q_SIGNALS:
-    void kanjiClicked(const QChar &kanji);
+    void kanjiClicked(char32_t kanji);
     void wordSearchRequested(const QString &text);
 
 private Q_SLOTS:
@@ -31,7 +31,7 @@ private Q_SLOTS:
 private:
     ResultsView *_resultsView;
 
-    static bool isCJKCharacter(const QChar &ch);
+    static bool isCJKCharacter(char32_t value);
 };
 
 #endif
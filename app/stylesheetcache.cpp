@@ -0,0 +1,53 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "stylesheetcache.h"
+
+#include <QGuiApplication>
+
+StyleSheetCache::StyleSheetCache()
+    : QObject(QCoreApplication::instance())
+{
+    connect(qGuiApp, &QGuiApplication::fontChanged, this, &StyleSheetCache::invalidate);
+}
+
+StyleSheetCache *StyleSheetCache::self()
+{
+    // Owned by the application object
+    static StyleSheetCache *cache = new StyleSheetCache;
+    return cache;
+}
+
+void StyleSheetCache::invalidate()
+{
+    _invalidateScheduled = false;
+    for (QString &sheet : _sheets) {
+        sheet.clear();
+    }
+
+    Q_EMIT invalidated();
+}
+
+void StyleSheetCache::scheduleInvalidate()
+{
+    if (!_invalidateScheduled) {
+        _invalidateScheduled = true;
+        QMetaObject::invokeMethod(this, &StyleSheetCache::invalidate, Qt::QueuedConnection);
+    }
+}
+
+QString StyleSheetCache::styleSheet(Sheet sheet, const std::function<QString()> &generate)
+{
+    QString &cached = _sheets[sheet];
+    if (cached.isEmpty()) {
+        cached = generate();
+    }
+
+    return cached;
+}
+
+#include "moc_stylesheetcache.cpp"
@@ -0,0 +1,64 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef STYLESHEETCACHE_H
+#define STYLESHEETCACHE_H
+
+#include <QObject>
+#include <QString>
+
+#include <functional>
+
+/**
+ * Keeps the CSS of the result view and the kanji and word pages, so it is
+ * only generated again when the palette, the application font or the
+ * configured font changes. Views listen to invalidated() and give the new
+ * sheet to their documents once, instead of embedding it in every page.
+ * Views see palette and font changes in their changeEvent() and call
+ * scheduleInvalidate().
+ */
+class StyleSheetCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Sheet {
+        ResultsSheet,
+        KanjiPageSheet,
+        WordPageSheet,
+        SheetCount
+    };
+
+    static StyleSheetCache *self();
+
+    /**
+     * Returns the cached sheet, calling @p generate if there is none yet
+     */
+    QString styleSheet(Sheet sheet, const std::function<QString()> &generate);
+
+public Q_SLOTS:
+    /**
+     * Drop every sheet, for instance after the font setting changed
+     */
+    void invalidate();
+    /**
+     * invalidate() once control returns to the event loop, so the views
+     * that all see the same palette change only cause it once
+     */
+    void scheduleInvalidate();
+
+Q_SIGNALS:
+    void invalidated();
+
+private:
+    StyleSheetCache();
+
+    QString _sheets[SheetCount];
+    bool _invalidateScheduled = false;
+};
+
+#endif
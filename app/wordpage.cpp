@@ -12,11 +12,15 @@
 #include "dictquery.h"
 #include "entrylist.h"
 #include "kitenconfig.h"
+#include "stylesheetcache.h"
 
 #include <KColorScheme>
 #include <KLocalizedString>
 
+#include <QEvent>
+#include <QHash>
 #include <QTextBrowser>
+#include <QTextDocument>
 #include <QUrl>
 #include <QVBoxLayout>
 
@@ -33,6 +37,17 @@ WordPage::WordPage(QWidget *parent)
     _browser->setOpenLinks(false);
     _browser->setOpenExternalLinks(false);
     connect(_browser, &QTextBrowser::anchorClicked, this, &WordPage::handleLinkClicked);
+    connect(StyleSheetCache::self(), &StyleSheetCache::invalidated, this, &WordPage::updateStyleSheet);
+    updateStyleSheet();
+}
+
+void WordPage::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::PaletteChange || event->type() == QEvent::FontChange) {
+        StyleSheetCache::self()->scheduleInvalidate();
+    }
+
+    QWidget::changeEvent(event);
 }
 
 void WordPage::setWord(const QString &word, const QString &reading, DictionaryManager *dictManager)
@@ -72,17 +87,19 @@ void WordPage::setWord(const QString &word, const QString &reading, DictionaryMa
     }
 
     QString html;
-    html += QStringLiteral("<html><head><style>%1</style></head><body>").arg(generateCSS());
+    html += QStringLiteral("<html><body>");
 
     if (bestEntry) {
         // Word header with clickable kanji
+        // Kanji outside the BMP are surrogate pairs, so go over code points
+        const QList<uint> codePoints = bestEntry->getWord().toUcs4();
         QString linkedWord;
-        for (int i = 0; i < bestEntry->getWord().length(); ++i) {
-            QChar ch = bestEntry->getWord().at(i);
-            if (isCJKCharacter(ch)) {
-                linkedWord += QStringLiteral("<a href=\"kanji:%1\">%1</a>").arg(ch);
+        for (const char32_t codePoint : codePoints) {
+            const QString character = QString::fromUcs4(&codePoint, 1);
+            if (isCJKCharacter(codePoint)) {
+                linkedWord += QStringLiteral("<a href=\"kanji:%1\">%1</a>").arg(character);
             } else {
-                linkedWord += ch;
+                linkedWord += character;
             }
         }
 
@@ -108,33 +125,27 @@ void WordPage::setWord(const QString &word, const QString &reading, DictionaryMa
             html += QStringLiteral("</ol></div>");
         }
 
-        // Kanji breakdown
-        QList<QChar> kanjiChars;
-        for (int i = 0; i < bestEntry->getWord().length(); ++i) {
-            QChar ch = bestEntry->getWord().at(i);
-            if (isCJKCharacter(ch)) {
-                kanjiChars.append(ch);
+        // Kanji breakdown, looking all of them up at once
+        QStringList kanjiChars;
+        for (const char32_t codePoint : codePoints) {
+            if (isCJKCharacter(codePoint)) {
+                kanjiChars.append(QString::fromUcs4(&codePoint, 1));
             }
         }
 
+        EntryList *kanjiResults = dictManager->lookupAllKanji(bestEntry->getWord());
+        QHash<QString, EntryKanjidic *> kanjiEntries;
+        for (Entry *entry : std::as_const(*kanjiResults)) {
+            kanjiEntries.insert(entry->getWord(), static_cast<EntryKanjidic *>(entry));
+        }
+
         if (!kanjiChars.isEmpty()) {
             html += QStringLiteral("<div class=\"section\">"
                                    "<p class=\"section-title\">%1</p>")
                         .arg(i18n("Kanji in this word"));
 
-            for (const QChar &ch : kanjiChars) {
-                // Look up each kanji
-                DictQuery kanjiQuery{QString{ch}};
-                EntryList *kanjiResults = dictManager->doSearch(kanjiQuery);
-
-                EntryKanjidic *kanjiEntry = nullptr;
-                for (int j = 0; j < kanjiResults->count(); ++j) {
-                    auto entry = dynamic_cast<EntryKanjidic *>(kanjiResults->at(j));
-                    if (entry) {
-                        kanjiEntry = entry;
-                        break;
-                    }
-                }
+            for (const QString &ch : std::as_const(kanjiChars)) {
+                EntryKanjidic *kanjiEntry = kanjiEntries.value(ch);
 
                 html += QStringLiteral("<div class=\"kanji-breakdown\">"
                                        "<a href=\"kanji:%1\" class=\"kanji-link\">%1</a>")
@@ -163,18 +174,20 @@ void WordPage::setWord(const QString &word, const QString &reading, DictionaryMa
                 }
 
                 html += QStringLiteral("</div>");
-                kanjiResults->deleteAll();
-                delete kanjiResults;
             }
 
             html += QStringLiteral("</div>");
         }
+
+        kanjiResults->deleteAll();
+        delete kanjiResults;
     } else {
         html += QStringLiteral("<p>%1</p>").arg(i18n("No entry found for \"%1\"", word));
     }
 
     html += QStringLiteral("</body></html>");
 
+    _html = html;
     _browser->setHtml(html);
 
     results->deleteAll();
@@ -186,12 +199,27 @@ void WordPage::handleLinkClicked(const QUrl &url)
     QString urlStr = url.toString();
 
     if (urlStr.startsWith("kanji:"_L1)) {
-        QString kanjiStr = urlStr.mid(6);
-        if (!kanjiStr.isEmpty()) {
-            Q_EMIT kanjiClicked(kanjiStr.at(0));
+        const QList<uint> kanji = QStringView(urlStr).mid(6).toUcs4();
+        if (!kanji.isEmpty()) {
+            Q_EMIT kanjiClicked(kanji.first());
         }
-    } else if (urlStr.length() == 1 && isCJKCharacter(urlStr.at(0))) {
-        Q_EMIT kanjiClicked(urlStr.at(0));
+    } else if (const QList<uint> kanji = urlStr.toUcs4(); kanji.size() == 1 && isCJKCharacter(kanji.first())) {
+        Q_EMIT kanjiClicked(kanji.first());
+    }
+}
+
+/**
+ * The style sheet is set on the document once, setHtml() reuses it
+ */
+void WordPage::updateStyleSheet()
+{
+    const QString css = StyleSheetCache::self()->styleSheet(StyleSheetCache::WordPageSheet, [this]() {
+        return generateCSS();
+    });
+
+    _browser->document()->setDefaultStyleSheet(css);
+    if (!_html.isEmpty()) {
+        _browser->setHtml(_html);
     }
 }
 
@@ -228,9 +256,8 @@ QString WordPage::generateCSS() const
         .arg(scheme.shade(KColorScheme::MidlightShade).name());                  // %10
 }
 
-bool WordPage::isCJKCharacter(const QChar &ch)
+bool WordPage::isCJKCharacter(char32_t value)
 {
-    ushort value = ch.unicode();
     if (value < 255) {
         return false;
     }
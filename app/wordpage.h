@@ -23,16 +23,24 @@ public:
     void setWord(const QString &word, const QString &reading, DictionaryManager *dictManager);
 
 Q_SIGNALS:
-    void kanjiClicked(const QChar &kanji);
+    void kanjiClicked(char32_t kanji);
+
+protected:
+    void changeEvent(QEvent *event) override;
 
 private Q_SLOTS:
     void handleLinkClicked(const QUrl &url);
+    void updateStyleSheet();
 
 private:
     QString generateCSS() const;
-    static bool isCJKCharacter(const QChar &ch);
+    static bool isCJKCharacter(char32_t value);
 
     QTextBrowser *_browser;
+    /**
+     * The last page shown, without the style sheet
+     */
+    QString _html;
 };
 
 #endif
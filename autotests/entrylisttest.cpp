@@ -0,0 +1,72 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "DictKanjidic/entrykanjidic.h"
+#include "entryarena.h"
+#include "entrylist.h"
+
+#include <QTest>
+
+using namespace Qt::StringLiterals;
+
+class EntryListTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void detachUnshared();
+    void detachShared();
+};
+
+static const QString sampleLine = u"亜 3021 U4e9c B1 G8 S7 F1509 ア つ.ぐ {Asia} {rank next}"_s;
+
+void EntryListTest::detachUnshared()
+{
+    EntryList list;
+    Entry *entry = list.arena()->create<EntryKanjidic>(u"kanjidic"_s, sampleLine);
+    entry->setRowId(1);
+    list.append(entry);
+
+    // Nobody else can see the entry, it is edited in place
+    QCOMPARE(list.detachEntry(0), entry);
+    QCOMPARE(list.at(0), entry);
+    QCOMPARE(entry->getRowId(), 0u);
+}
+
+void EntryListTest::detachShared()
+{
+    EntryList list;
+    Entry *entry = list.arena()->create<EntryKanjidic>(u"kanjidic"_s, sampleLine);
+    entry->setRowId(1);
+    list.append(entry);
+
+    EntryList copy(list);
+    Entry *detached = copy.detachEntry(0);
+    QVERIFY(detached != entry);
+    QCOMPARE(copy.at(0), detached);
+    QCOMPARE(detached->getWord(), entry->getWord());
+    QCOMPARE(detached->getRowId(), 0u);
+
+    // The list we copied keeps its entry as it was
+    QCOMPARE(list.at(0), entry);
+    QCOMPARE(entry->getRowId(), 1u);
+
+    // Editing the same row again does not copy it once more
+    QCOMPARE(copy.detachEntry(0), detached);
+    QCOMPARE(copy.at(0), detached);
+    QCOMPARE(copy.arena()->count(), 1);
+
+    // Until the list is copied again
+    EntryList again(copy);
+    Entry *third = again.detachEntry(0);
+    QVERIFY(third != detached);
+    QCOMPARE(copy.at(0), detached);
+}
+
+QTEST_GUILESS_MAIN(EntryListTest)
+
+#include "entrylisttest.moc"
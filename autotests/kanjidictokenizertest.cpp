@@ -0,0 +1,229 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "DictKanjidic/entrykanjidic.h"
+#include "DictKanjidic/kanjidictokenizer.h"
+
+#include <QFile>
+#include <QStringDecoder>
+#include <QTest>
+
+#include <algorithm>
+
+using namespace Qt::StringLiterals;
+
+class KanjidicTokenizerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void tokens();
+    void codes_data();
+    void codes();
+    void malformed_data();
+    void malformed();
+    void truncated();
+    void benchmarkTokenizer();
+    void benchmarkLoadEntry();
+
+private:
+    /**
+     * Tokenizes @p line into @p tokens, returns false if a token does not
+     * lie within the line
+     */
+    static bool tokenize(QStringView line, QList<KanjidicTokenizer::Token> &tokens);
+
+    QStringList m_lines;
+};
+
+static const QString sampleLine = u"亜 3021 U4e9c B1 C7 G8 S7 XJ05033 F1509 J1 N43 V81 H3540 DK2204 L1809 K1331 O525 DO1788 MN272 "
+                                  u"MP1.0525 E997 IN1616 DF1032 DT109 DJ1807 DG1456 I4c1.2 Q1010.6 Yya4 Wa ア つ.ぐ T1 つぎ つぐ {Asia} {rank next}"_s;
+
+void KanjidicTokenizerTest::initTestCase()
+{
+    QFile file(QStringLiteral(KANJIDIC_FILE));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QStringDecoder decoder("EUC-JP");
+    const QString decoded = decoder(file.readAll());
+    for (QStringView line : QStringView(decoded).split(u'\n', Qt::SkipEmptyParts)) {
+        if (line.at(0) != u'#') {
+            m_lines.append(line.toString());
+        }
+    }
+}
+
+bool KanjidicTokenizerTest::tokenize(QStringView line, QList<KanjidicTokenizer::Token> &tokens)
+{
+    tokens.clear();
+    KanjidicTokenizer tokenizer(line);
+    KanjidicTokenizer::Token token;
+    while (tokenizer.next(token)) {
+        for (QStringView part : {token.code, token.value}) {
+            if (!part.isEmpty() && (part.data() < line.data() || part.data() + part.size() > line.data() + line.size())) {
+                return false;
+            }
+        }
+        tokens.append(token);
+        // Every token takes at least one character
+        if (tokens.size() > line.size()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void KanjidicTokenizerTest::tokens()
+{
+    QList<KanjidicTokenizer::Token> tokens;
+    QVERIFY(tokenize(sampleLine, tokens));
+    QVERIFY(tokens.size() > 4);
+    QCOMPARE(tokens.first().type, KanjidicTokenizer::Kanji);
+    QCOMPARE(tokens.first().value.toString(), u"亜"_s);
+    QCOMPARE(tokens.at(1).type, KanjidicTokenizer::JisCode);
+    QCOMPARE(tokens.at(1).value.toString(), u"3021"_s);
+
+    QStringList readings;
+    QStringList meanings;
+    for (const KanjidicTokenizer::Token &token : tokens) {
+        if (token.type == KanjidicTokenizer::Reading) {
+            readings.append(token.value.toString());
+        } else if (token.type == KanjidicTokenizer::Meaning) {
+            meanings.append(token.value.toString());
+        } else if (token.type == KanjidicTokenizer::ReadingTypeMarker) {
+            QCOMPARE(token.value.toString(), u"1"_s);
+        }
+    }
+    QCOMPARE(readings, QStringList({u"ア"_s, u"つ.ぐ"_s, u"つぎ"_s, u"つぐ"_s}));
+    QCOMPARE(meanings, QStringList({u"Asia"_s, u"rank next"_s}));
+
+    QCOMPARE(KanjidicTokenizer::field(sampleLine, u"G").toString(), u"8"_s);
+    QCOMPARE(KanjidicTokenizer::field(sampleLine, u"S").toString(), u"7"_s);
+    QVERIFY(KanjidicTokenizer::field(sampleLine, u"R").isNull());
+}
+
+void KanjidicTokenizerTest::codes_data()
+{
+    QTest::addColumn<QString>("code");
+    QTest::addColumn<QString>("value");
+
+    QTest::newRow("one letter") << u"B"_s << u"1"_s;
+    QTest::newRow("D code") << u"DK"_s << u"K2204"_s;
+    QTest::newRow("Morohashi index") << u"MN"_s << u"N272"_s;
+    QTest::newRow("Morohashi page") << u"MP"_s << u"P1.0525"_s;
+    QTest::newRow("Kanji & Kana") << u"IN"_s << u"N1616"_s;
+    QTest::newRow("Kanji Dictionary") << u"I4"_s << u"4c1.2"_s;
+}
+
+void KanjidicTokenizerTest::codes()
+{
+    QFETCH(QString, code);
+    QFETCH(QString, value);
+
+    QCOMPARE(KanjidicTokenizer::field(sampleLine, code).toString(), value);
+
+    // The entry shows the codes the way they were always shown
+    EntryKanjidic entry(u"kanjidic"_s, sampleLine);
+    QCOMPARE(entry.getExtendedInfoItem(code), value);
+    QVERIFY(entry.extendedItemCheck(code, value));
+}
+
+void KanjidicTokenizerTest::malformed_data()
+{
+    QTest::addColumn<QString>("line");
+    QTest::addColumn<int>("meanings");
+
+    QTest::newRow("empty") << QString() << 0;
+    QTest::newRow("spaces") << u"   "_s << 0;
+    QTest::newRow("kanji only") << u"亜"_s << 0;
+    QTest::newRow("truncated code") << u"亜 3021 U"_s << 0;
+    QTest::newRow("truncated two letter code") << u"亜 3021 D"_s << 0;
+    QTest::newRow("truncated marker") << u"亜 3021 T"_s << 0;
+    QTest::newRow("unclosed brace") << u"亜 3021 {Asia"_s << 1;
+    QTest::newRow("lone brace") << u"亜 3021 {"_s << 1;
+    QTest::newRow("unopened brace") << u"亜 3021 Asia} {rank}"_s << 1;
+    QTest::newRow("trailing spaces") << u"亜 3021 {Asia}   "_s << 1;
+    QTest::newRow("lone high surrogate") << QString(QChar(0xd840)) << 0;
+    QTest::newRow("lone low surrogate") << (u"亜 3021 "_s + QChar(0xdc0b)) << 0;
+    QTest::newRow("surrogate in meaning") << (u"亜 3021 {"_s + QChar(0xd840)) << 1;
+    QTest::newRow("supplementary kanji") << u"𠀋 0000 U2000b S9 {?}"_s << 1;
+}
+
+void KanjidicTokenizerTest::malformed()
+{
+    QFETCH(QString, line);
+    QFETCH(int, meanings);
+
+    QList<KanjidicTokenizer::Token> tokens;
+    QVERIFY(tokenize(line, tokens));
+    const int found = std::count_if(tokens.cbegin(), tokens.cend(), [](const KanjidicTokenizer::Token &token) {
+        return token.type == KanjidicTokenizer::Meaning;
+    });
+    QCOMPARE(found, meanings);
+
+    EntryKanjidic entry(u"kanjidic"_s);
+    entry.loadEntry(line);
+    QCOMPARE(entry.getMeaningsList().size(), meanings);
+}
+
+void KanjidicTokenizerTest::truncated()
+{
+    // Every prefix of real lines, which cuts codes, readings, meanings
+    // and surrogate pairs at every possible place
+    QStringList lines({sampleLine, u"𠀋 0000 U2000b S9 𠀋 {𠀋}"_s});
+    lines += m_lines.mid(0, 50);
+    for (const QString &line : std::as_const(lines)) {
+        for (qsizetype length = 0; length <= line.size(); ++length) {
+            const QString prefix = line.first(length);
+            QList<KanjidicTokenizer::Token> tokens;
+            QVERIFY(tokenize(prefix, tokens));
+            EntryKanjidic entry(u"kanjidic"_s);
+            entry.loadEntry(prefix);
+        }
+    }
+}
+
+void KanjidicTokenizerTest::benchmarkTokenizer()
+{
+    if (m_lines.isEmpty()) {
+        QSKIP("The kanjidic of the source tree is missing");
+    }
+
+    qsizetype count = 0;
+    QBENCHMARK {
+        for (const QString &line : std::as_const(m_lines)) {
+            KanjidicTokenizer tokenizer(line);
+            KanjidicTokenizer::Token token;
+            while (tokenizer.next(token)) {
+                ++count;
+            }
+        }
+    }
+    QVERIFY(count > 0);
+}
+
+void KanjidicTokenizerTest::benchmarkLoadEntry()
+{
+    if (m_lines.isEmpty()) {
+        QSKIP("The kanjidic of the source tree is missing");
+    }
+
+    QBENCHMARK {
+        for (const QString &line : std::as_const(m_lines)) {
+            EntryKanjidic entry(u"kanjidic"_s);
+            entry.loadEntry(line);
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(KanjidicTokenizerTest)
+
+#include "kanjidictokenizertest.moc"
@@ -9,11 +9,11 @@
 
 #include "ui_preferences.h"
 
-#include "DictKanjidic/dictfilekanjidic.h"
 #include "kanjibrowserconfig.h"
 #include "kanjibrowserview.h"
 #include "kitenmacros.h"
 
+#include <QStandardPaths>
 #include <QStatusBar>
 
 #include <KActionCollection>
@@ -21,11 +21,8 @@
 #include <KLocalizedString>
 #include <KStandardAction>
 
-using namespace Qt::StringLiterals;
-
 KanjiBrowser::KanjiBrowser()
     : KXmlGuiWindow()
-    , _dictFileKanjidic(nullptr)
 {
     // Read the configuration file.
     _config = KanjiBrowserConfigSkeleton::self();
@@ -50,9 +47,7 @@ KanjiBrowser::KanjiBrowser()
 
 KanjiBrowser::~KanjiBrowser()
 {
-    if (_dictFileKanjidic) {
-        delete _dictFileKanjidic;
-    }
+    _dictionaryManager.removeAllDictionaries();
 }
 
 void KanjiBrowser::changeStatusBar(const QString &text)
@@ -62,63 +57,17 @@ void KanjiBrowser::changeStatusBar(const QString &text)
 
 void KanjiBrowser::loadKanji()
 {
-    if (_dictFileKanjidic) {
+    if (!_dictionaryManager.listDictionaries().isEmpty()) {
         return;
     }
 
     qDebug() << "Loading kanji...";
 
     QString dictionary = QStandardPaths::locate(QStandardPaths::GenericDataLocation, QStringLiteral("kiten/kanjidic"));
-    _dictFileKanjidic = new DictFileKanjidic();
-    _dictFileKanjidic->loadSettings();
-    _dictFileKanjidic->loadDictionary(dictionary, KANJIDIC);
-
-    // Parse the contents of KANJIDIC that we need to create the view.
-    // We need:
-    //  - Kanji
-    //  - Grade
-    //  - Number of strokes
-    QRegularExpression gradeMatch(QStringLiteral("^G\\d+"));
-    QRegularExpression strokeMatch(QStringLiteral("^S\\d+"));
-    QList<int> gradeList;
-    QList<int> strokeList;
-    QHash<QString, QPair<int, int>> kanjiList;
-    for (const QString &line : _dictFileKanjidic->dumpDictionary()) {
-        // All the kanji without grade will have Grade 0, making easy to
-        // manage that information in KanjiBrowserView.
-        int grade = 0;
-        int strokes = 0;
-        QStringList gradeSection = line.split(' '_L1, Qt::SkipEmptyParts).filter(gradeMatch);
-        QStringList strokesSection = line.split(' '_L1, Qt::SkipEmptyParts).filter(strokeMatch);
-
-        // There are some kanji without grade (example: those not in Jouyou list).
-        if (!gradeSection.isEmpty()) {
-            // In KANJIDIC the grade/stroke section is: G# (for grade)
-            //                                          S# (for strokes)
-            // where # can be one or more digits.
-            // We remove the first character and convert the remaining ones to int.
-            grade = gradeSection.first().remove(0, 1).toInt();
-            gradeList << grade;
-        }
-
-        strokes = strokesSection.first().remove(0, 1).toInt();
-        strokeList << strokes;
-
-        // Insert the extracted information into our QHash.
-        kanjiList.insert(line[0], qMakePair(grade, strokes));
-    }
-
-    // This conversion from QList to QSet to QList, is to remove duplicated items.
-    std::sort(gradeList.begin(), gradeList.end());
-    gradeList.erase(std::unique(gradeList.begin(), gradeList.end()), gradeList.end());
-
-    std::sort(strokeList.begin(), strokeList.end());
-    strokeList.erase(std::unique(strokeList.begin(), strokeList.end()), strokeList.end());
-    qDebug() << "Max. grade:" << gradeList.last();
-    qDebug() << "Max. stroke count:" << strokeList.last();
+    _dictionaryManager.addDictionary(dictionary, KANJIDIC, KANJIDIC);
 
     // Finally setup the view.
-    _view->setupView(this, kanjiList, gradeList, strokeList);
+    _view->setupView(actionCollection(), &_dictionaryManager);
 }
 
 void KanjiBrowser::showPreferences()
@@ -10,14 +10,13 @@
 
 #include <KXmlGuiWindow>
 
-class DictFileKanjidic;
+#include "dictionarymanager.h"
+
 class KanjiBrowserConfigSkeleton;
 class KanjiBrowserView;
 
 class KanjiBrowser : public KXmlGuiWindow
 {
-    friend class KanjiBrowserView;
-
     Q_OBJECT
 
 public:
@@ -36,16 +35,15 @@ private Q_SLOTS:
 
 private:
     /**
-     * Load KANJIDIC dictionary and parse the necessary information and
-     * calls KanjiBrowserView::setupView() member function to finish the setup.
-     * This should be called only once at initial setup of KanjiBrowser or to
-     * reload the dictionary in case of updates.
+     * Load KANJIDIC dictionary and calls KanjiBrowserView::setupView()
+     * member function to finish the setup. This should be called only
+     * once at initial setup of KanjiBrowser.
      */
     void loadKanji();
 
     KanjiBrowserConfigSkeleton *_config;
     KanjiBrowserView *_view;
-    DictFileKanjidic *_dictFileKanjidic;
+    DictionaryManager _dictionaryManager;
 };
 
 #endif
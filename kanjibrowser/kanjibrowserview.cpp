@@ -7,12 +7,13 @@
 
 #include "kanjibrowserview.h"
 
-#include "DictKanjidic/dictfilekanjidic.h"
 #include "DictKanjidic/entrykanjidic.h"
+#include "DictKanjidic/kanjitable.h"
+#include "dictionarymanager.h"
 #include "dictquery.h"
 #include "entrylist.h"
-#include "kanjibrowser.h"
 #include "kanjibrowserconfig.h"
+#include "kitenmacros.h"
 #include "searchdialog.h"
 
 #include <KActionCollection>
@@ -20,15 +21,28 @@
 #include <KMessageBox>
 #include <QAction>
 #include <QClipboard>
+#include <QStringListModel>
+
+#include <algorithm>
 
 KanjiBrowserView::KanjiBrowserView(QWidget *parent)
     : QWidget(parent)
     , _currentKanji(nullptr)
+    , _kanjiModel(new QStringListModel(this))
 {
     setupUi(this);
     loadSettings();
 }
 
+int KanjiBrowserView::bucketIndex(int grade, int strokes) const
+{
+    if (grade < 0 || strokes < 0 || strokes > _maxStrokes) {
+        return -1;
+    }
+
+    return grade * (_maxStrokes + 1) + strokes;
+}
+
 void KanjiBrowserView::changeGrade(const int grade)
 {
     _currentGradeList.clear();
@@ -64,7 +78,7 @@ void KanjiBrowserView::changeGrade(const int grade)
         _currentGradeList << grade;
     }
 
-    // Reload our QListWidget widget.
+    // Reload the kanji list.
     reloadKanjiList();
 }
 
@@ -92,7 +106,7 @@ void KanjiBrowserView::changeStrokeCount(const int strokes)
         _currentStrokesList << strokes;
     }
 
-    // Reload our QListWidget widget.
+    // Reload the kanji list.
     reloadKanjiList();
 }
 
@@ -169,19 +183,18 @@ void KanjiBrowserView::reloadKanjiList()
 {
     // Grade and strokes lists have the information of
     // which kanji we are going to filter.
-    // We just iterate on them to actually do the filtering.
+    // We just collect the buckets of every combination.
     QStringList list;
     for (const int strokes : _currentStrokesList) {
         for (const int grade : _currentGradeList) {
-            list.append(_kanji.keys(qMakePair(grade, strokes)));
+            list.append(_kanjiBuckets.value(bucketIndex(grade, strokes)));
         }
     }
 
-    _kanjiList->clear();
-    _kanjiList->addItems(list);
+    _kanjiModel->setStringList(list);
 
     // Update our status bar with the number of kanji filtered.
-    statusBarChanged(i18np("%1 kanji found", "%1 kanji found", _kanjiList->count()));
+    statusBarChanged(i18np("%1 kanji found", "%1 kanji found", list.count()));
 }
 
 void KanjiBrowserView::searchKanji(const QString &term)
@@ -190,7 +203,35 @@ void KanjiBrowserView::searchKanji(const QString &term)
         return;
     }
 
-    if (auto result = _parent->_dictFileKanjidic->doSearch(DictQuery(term)); result != nullptr && !result->isEmpty()) {
+    // A single kanji is looked up directly, anything else is searched for
+    EntryList *result = nullptr;
+    const QList<uint> codePoints = term.toUcs4();
+    if (codePoints.size() == 1) {
+        result = _dictionaryManager->lookupKanji(codePoints.first());
+    } else {
+        DictQuery query(term);
+        query.setDictionaries(_dictionaries);
+        result = _dictionaryManager->doSearch(query);
+    }
+
+    // A reading or any other search with several kanji lists all of them,
+    // "all kanji read こう" is answered by the reading index
+    if (result != nullptr && result->count() > 1) {
+        QStringList kanji;
+        kanji.reserve(result->count());
+        for (const Entry *entry : std::as_const(*result)) {
+            kanji.append(entry->getWord());
+        }
+        result->deleteAll();
+        delete result;
+
+        _kanjiModel->setStringList(kanji);
+        Q_EMIT statusBarChanged(i18np("%1 kanji found", "%1 kanji found", kanji.count()));
+        changeToListPage();
+        return;
+    }
+
+    if (result != nullptr && !result->isEmpty()) {
         auto kanji = dynamic_cast<EntryKanjidic *>(result->first());
         _currentKanji = kanji;
 
@@ -200,34 +241,81 @@ void KanjiBrowserView::searchKanji(const QString &term)
 
         showKanjiInformation(kanji);
         _goToKanjiInfo->triggered();
+        Q_EMIT kanjiSelected(_currentKanji->getWord());
     }
 }
 
-void KanjiBrowserView::setupView(KanjiBrowser *parent, const QHash<QString, QPair<int, int>> &kanji, QList<int> &kanjiGrades, QList<int> &strokeCount)
+void KanjiBrowserView::setupView(KActionCollection *actions, const DictionaryManager *dictionaryManager)
 {
-    if (kanji.isEmpty() || kanjiGrades.isEmpty() || strokeCount.isEmpty()) {
+    _dictionaryManager = dictionaryManager;
+    _dictionaries = dictionaryManager->listDictionariesOfType(KANJIDIC);
+
+    // The dictionary already parsed the kanji, their grade and their
+    // number of strokes are all we need to create the view.
+    KanjiTable::Pointer table;
+    if (!_dictionaries.isEmpty()) {
+        table = KanjiTable::load(dictionaryManager->listDictionaryInfo(_dictionaries.first()).second);
+    }
+
+    QList<int> kanjiGrades;
+    QList<int> strokeCount;
+    for (int row = 0; table && row < table->size(); ++row) {
+        // There are some kanji without grade (example: those not in Jouyou list).
+        if (table->grade(row) != 0) {
+            kanjiGrades << table->grade(row);
+        }
+        strokeCount << table->strokes(row);
+    }
+
+    // Remove the duplicated items.
+    std::sort(kanjiGrades.begin(), kanjiGrades.end());
+    kanjiGrades.erase(std::unique(kanjiGrades.begin(), kanjiGrades.end()), kanjiGrades.end());
+    std::sort(strokeCount.begin(), strokeCount.end());
+    strokeCount.erase(std::unique(strokeCount.begin(), strokeCount.end()), strokeCount.end());
+
+    if (kanjiGrades.isEmpty() || strokeCount.isEmpty()) {
         qDebug() << "One or more of our lists are empty (kanji, grades, strokes).";
         qDebug() << "Could not load the view properly.";
         KMessageBox::error(this, i18n("Could not load the necessary kanji information."));
         return;
     }
 
-    _parent = parent;
-    _kanji = kanji;
+    qDebug() << "Max. grade:" << kanjiGrades.last();
+    qDebug() << "Max. stroke count:" << strokeCount.last();
+
     _gradeList = kanjiGrades;
     _strokesList = strokeCount;
 
-    QAction *goToKanjiList = _parent->actionCollection()->addAction(QStringLiteral("kanji_list"));
+    // Sort the kanji into one bucket per grade and number of strokes, so
+    // changing the filter only has to look at the kanji it shows. All the
+    // kanji without grade are in grade 0.
+    _maxStrokes = _strokesList.last();
+    _kanjiBuckets.clear();
+    _kanjiBuckets.resize(bucketIndex(qMax(_gradeList.last(), 0), _maxStrokes) + 1);
+    for (int row = 0; row < table->size(); ++row) {
+        const int index = bucketIndex(table->grade(row), table->strokes(row));
+        if (index >= 0 && index < _kanjiBuckets.size()) {
+            _kanjiBuckets[index].append(table->kanji(row));
+        }
+    }
+    for (QStringList &bucket : _kanjiBuckets) {
+        bucket.sort();
+        bucket.erase(std::unique(bucket.begin(), bucket.end()), bucket.end());
+    }
+
+    _kanjiList->setModel(_kanjiModel);
+
+    QAction *goToKanjiList = actions->addAction(QStringLiteral("kanji_list"));
     goToKanjiList->setText(i18n("Kanji &List"));
 
-    _goToKanjiInfo = _parent->actionCollection()->addAction(QStringLiteral("kanji_info"));
+    _goToKanjiInfo = actions->addAction(QStringLiteral("kanji_info"));
     _goToKanjiInfo->setText(i18n("Kanji &Information"));
 
-    _searchKanjiAction = _parent->actionCollection()->addAction(QStringLiteral("search"));
+    _searchKanjiAction = actions->addAction(QStringLiteral("search"));
     _searchKanjiAction->setIcon(QIcon::fromTheme(QStringLiteral("search")));
     _searchKanjiAction->setText(i18n("&Search…"));
 
-    _copyToClipboard = _parent->actionCollection()->addAction(QStringLiteral("copy_kanji_to_clipboard"));
+    _copyToClipboard = actions->addAction(QStringLiteral("copy_kanji_to_clipboard"));
     _copyToClipboard->setVisible(false);
 
     _grades->addItem(i18n("All Jouyou Kanji grades"));
@@ -248,10 +336,10 @@ void KanjiBrowserView::setupView(KanjiBrowser *parent, const QHash<QString, QPai
 
     connect(_grades, static_cast<void (KComboBox::*)(int)>(&KComboBox::currentIndexChanged), this, &KanjiBrowserView::changeGrade);
     connect(_strokes, static_cast<void (KComboBox::*)(int)>(&KComboBox::currentIndexChanged), this, &KanjiBrowserView::changeStrokeCount);
-    connect(_kanjiList, &QListWidget::itemClicked, this, [this](QListWidgetItem *item) {
-        searchKanji(item->text());
+    connect(_kanjiList, &QListView::clicked, this, [this](const QModelIndex &index) {
+        searchKanji(index.data().toString());
     });
-    connect(_kanjiList, &QListWidget::itemClicked, _goToKanjiInfo, [this] {
+    connect(_kanjiList, &QListView::clicked, _goToKanjiInfo, [this] {
         _goToKanjiInfo->triggered();
     });
     connect(goToKanjiList, &QAction::triggered, this, &KanjiBrowserView::changeToListPage);
@@ -10,10 +10,11 @@
 
 #include "ui_kanjibrowserview.h"
 
+class DictionaryManager;
 class EntryKanjidic;
+class KActionCollection;
 class QAction;
-class KanjiBrowser;
-class QListWidgetItem;
+class QStringListModel;
 
 class KanjiBrowserView : public QWidget, private Ui::KanjiBrowserView
 {
@@ -29,14 +30,14 @@ public:
     ~KanjiBrowserView() override = default;
 
     /**
-     * Initial setup.
+     * Initial setup. The kanji, their grades and number of strokes are taken
+     * from the KANJIDIC dictionary of @p dictionaryManager, which is also
+     * used to look them up. The manager must outlive the view.
      *
-     * @param parent      parent to which we are going to add some QActions
-     * @param kanji       hash containing kanji with its grades and number of strokes
-     * @param kanjiGrades sorted list of grades found in KANJIDIC
-     * @param strokeCount sorted list of strokes found in KANJIDIC
+     * @param actions           collection to which we are going to add some QActions
+     * @param dictionaryManager dictionaries holding a KANJIDIC dictionary
      */
-    void setupView(KanjiBrowser *parent, const QHash<QString, QPair<int, int>> &kanji, QList<int> &kanjiGrades, QList<int> &strokeCount);
+    void setupView(KActionCollection *actions, const DictionaryManager *dictionaryManager);
 
 Q_SIGNALS:
     /**
@@ -45,6 +46,12 @@ Q_SIGNALS:
      * @param text new text to put in the status bar
      */
     void statusBarChanged(const QString &text);
+    /**
+     * Emitted when the information of a kanji is shown.
+     *
+     * @param kanji the kanji shown
+     */
+    void kanjiSelected(const QString &kanji);
 
 public Q_SLOTS:
     /**
@@ -90,7 +97,12 @@ private:
      */
     QString convertToCSS(const QFont &font);
     /**
-     * Reload the KListWidget items.
+     * The position of the kanji with @p grade and @p strokes in
+     * _kanjiBuckets, or -1 if there cannot be any.
+     */
+    int bucketIndex(int grade, int strokes) const;
+    /**
+     * Reload the kanji list with the kanji matching the current filter.
      */
     void reloadKanjiList();
     /**
@@ -129,9 +141,13 @@ private:
     };
 
     /**
-     * We need this as we are going to add some QActions to it.
+     * The dictionaries we look the kanji up in.
      */
-    KanjiBrowser *_parent;
+    const DictionaryManager *_dictionaryManager = nullptr;
+    /**
+     * The names of the KANJIDIC dictionaries of _dictionaryManager.
+     */
+    QStringList _dictionaries;
     /**
      * We need to update this action's text from different functions.
      */
@@ -149,9 +165,18 @@ private:
      */
     EntryKanjidic *_currentKanji;
     /**
-     * A hash containing all the kanji (found in KANJIDIC) we need to filter.
+     * All the kanji (found in KANJIDIC) we need to filter, in one bucket
+     * per grade and number of strokes. See bucketIndex().
+     */
+    QList<QStringList> _kanjiBuckets;
+    /**
+     * The highest number of strokes, the row length of _kanjiBuckets.
+     */
+    int _maxStrokes = 0;
+    /**
+     * The kanji shown in the list.
      */
-    QHash<QString, QPair<int, int>> _kanji;
+    QStringListModel *_kanjiModel;
     /**
      * A list containing all the kanji grades found in KANJIDIC.
      */
@@ -12,6 +12,7 @@
 
 #include "dictfileedict.h"
 #include "dictquery.h"
+#include "entryarena.h"
 #include "entryedict.h"
 #include "entrylist.h"
 
@@ -36,10 +37,10 @@ using namespace Qt::StringLiterals;
 // Declare our constants
 QList<Deinflection::Conjugation> *Deinflection::conjugationList = nullptr;
 
-Deinflection::Deinflection(const QString &name)
+Deinflection::Deinflection(StringPool::Atom dictionaryId)
     : m_deinflectionLabel(QString())
     , m_wordType(QString())
-    , m_dictionaryName(name)
+    , m_dictionaryId(dictionaryId)
 {
 }
 
@@ -53,7 +54,7 @@ QString *Deinflection::getWordType()
     return &m_wordType;
 }
 
-EntryList *Deinflection::search(const DictQuery &query, const QList<QString> &preliminaryResults)
+EntryList *Deinflection::search(const DictQuery &query, const LinearEdictFile &edict, const QList<int> &preliminaryResults)
 {
     if (conjugationList == nullptr) {
         return nullptr;
@@ -62,7 +63,11 @@ EntryList *Deinflection::search(const DictQuery &query, const QList<QString> &pr
     m_deinflectionLabel = QString();
     m_wordType = QString();
 
-    auto entries = new EntryList();
+    // The candidates are created in the arena of the results, so the ones we
+    // keep do not have to be moved anywhere
+    auto results = new EntryList();
+    EntryArena *arena = results->arena();
+    QList<EntryEdict *> entries;
 
     QStringList edictTypesList;
     edictTypesList.append(EdictFormatting::Adjectives);
@@ -70,32 +75,27 @@ EntryList *Deinflection::search(const DictQuery &query, const QList<QString> &pr
 
     QString edictTypes = edictTypesList.join(QLatin1Char(','));
 
-    for (const QString &item : preliminaryResults) {
-        EntryEdict *entry = makeEntry(item);
+    for (int line : preliminaryResults) {
+        EntryEdict *entry = makeEntry(arena, edict.line(line));
+        entry->setRowId(line + 1);
         QStringListIterator it(entry->getTypesList());
         bool matched = false;
         while (it.hasNext() && !matched) {
             if (edictTypes.contains(it.next())) {
-                entries->append(entry);
+                entries.append(entry);
                 matched = true;
             }
         }
         if (!matched)
-            delete entry;
+            arena->discard(entry);
     }
 
-    auto results = new EntryList();
-    EntryList::EntryIterator it(*entries);
-    while (it.hasNext()) {
-        auto entry = static_cast<EntryEdict *>(it.next());
-
+    for (EntryEdict *entry : std::as_const(entries)) {
         QString text = query.getWord();
         if (text.isEmpty()) {
             text = query.getPronunciation();
 
             if (text.isEmpty()) {
-                entries->deleteAll();
-                delete entries;
                 delete results;
                 return nullptr;
             }
@@ -127,7 +127,6 @@ EntryList *Deinflection::search(const DictQuery &query, const QList<QString> &pr
             }
         }
     }
-    delete entries;
     return results;
 }
 
@@ -193,7 +192,7 @@ bool Deinflection::load()
     return true;
 }
 
-inline EntryEdict *Deinflection::makeEntry(const QString &entry)
+inline EntryEdict *Deinflection::makeEntry(EntryArena *arena, const QString &entry)
 {
-    return new EntryEdict(m_dictionaryName, entry);
+    return arena->create<EntryEdict>(m_dictionaryId, entry);
 }
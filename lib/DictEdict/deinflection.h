@@ -16,16 +16,17 @@
 class DictQuery;
 class EntryEdict;
 class EntryList;
+class LinearEdictFile;
 class QString;
 
 class Deinflection
 {
 public:
-    explicit Deinflection(const QString &name);
+    explicit Deinflection(StringPool::Atom dictionaryId);
 
     QString *getDeinflectionLabel();
     QString *getWordType();
-    EntryList *search(const DictQuery &query, const QList<QString> &preliminaryResults);
+    EntryList *search(const DictQuery &query, const LinearEdictFile &edict, const QList<int> &preliminaryResults);
     bool load();
 
 private:
@@ -38,13 +39,13 @@ private:
         QString label;
     };
 
-    EntryEdict *makeEntry(const QString &entry);
+    EntryEdict *makeEntry(EntryArena *arena, const QString &entry);
 
     static QList<Conjugation> *conjugationList;
 
     QString m_deinflectionLabel;
     QString m_wordType;
-    const QString m_dictionaryName;
+    const StringPool::Atom m_dictionaryId;
 };
 
 #endif
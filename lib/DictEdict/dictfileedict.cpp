@@ -19,17 +19,22 @@
 #include <QStringDecoder>
 #include <QTextStream>
 
+#include <algorithm>
+
 #include "deinflection.h"
 #include "dictfilefieldselector.h"
 #include "dictquery.h"
+#include "entryarena.h"
 #include "entryedict.h"
 #include "entrylist.h"
+#include "fragmentcache.h"
 #include "kitenmacros.h"
 
 using namespace Qt::StringLiterals;
 
 QString *DictFileEdict::deinflectionLabel = nullptr;
 QStringList *DictFileEdict::displayFields = nullptr;
+DisplayTemplate::Slot DictFileEdict::displayTemplate;
 QString *DictFileEdict::wordType = nullptr;
 
 /**
@@ -62,6 +67,41 @@ QMap<QString, QString> DictFileEdict::displayOptions() const
     return list;
 }
 
+EntryList *DictFileEdict::compoundsForKanji(char32_t kanji, int limit, int *total)
+{
+    auto results = new EntryList();
+    const QList<int> lines = m_edictFile.compoundsOf(kanji);
+    if (total) {
+        *total = lines.size();
+    }
+
+    EntryArena *arena = results->arena();
+    const int count = qMin<int>(limit, lines.size());
+    for (int i = 0; i < count; ++i) {
+        Entry *entry = makeEntry(arena, m_edictFile.line(lines.at(i)));
+        entry->setRowId(lines.at(i) + 1);
+        results->append(entry);
+    }
+
+    return results;
+}
+
+Entry *DictFileEdict::entryForRow(EntryArena *arena, quint32 rowId)
+{
+    if (rowId == 0 || !m_edictFile.valid()) {
+        return nullptr;
+    }
+
+    const QString line = m_edictFile.line(rowId - 1);
+    if (line.isEmpty()) {
+        return nullptr;
+    }
+
+    Entry *entry = makeEntry(arena, line);
+    entry->setRowId(rowId);
+    return entry;
+}
+
 /**
  * Do a search, respond with a list of entries.
  * The general strategy will be to take the first word of the query, and do a
@@ -101,7 +141,7 @@ EntryList *DictFileEdict::doSearch(const DictQuery &query)
         firstChoice = firstChoice.at(0);
     }
 
-    QList<QString> preliminaryResults = m_edictFile.findMatches(firstChoice);
+    QList<int> preliminaryResults = m_edictFile.findMatches(firstChoice);
 
     if (preliminaryResults.empty()) // If there were no matches... return an empty list
     {
@@ -109,14 +149,16 @@ EntryList *DictFileEdict::doSearch(const DictQuery &query)
     }
 
     auto results = new EntryList();
-    for (const QString &it : preliminaryResults) {
-        //     qDebug() << "result: " << it << endl;
-        Entry *result = makeEntry(it);
+    EntryArena *arena = results->arena();
+    const Entry::QueryProperties properties = Entry::queryProperties(query);
+    for (int line : preliminaryResults) {
+        Entry *result = makeEntry(arena, m_edictFile.line(line));
+        result->setRowId(line + 1);
         auto resultEdict = static_cast<EntryEdict *>(result);
-        if (result->matchesQuery(query) && resultEdict->matchesWordType(query)) {
+        if (result->matchesQuery(query, properties) && resultEdict->matchesWordType(query)) {
             results->append(result);
         } else {
-            delete result;
+            arena->discard(result);
         }
     }
 
@@ -128,7 +170,7 @@ EntryList *DictFileEdict::doSearch(const DictQuery &query)
     bool isAdjectiveQuery = query.getMatchWordType() == DictQuery::Adjective;
     if (results->count() == 0 && (isAnyQuery || isVerbQuery || isAdjectiveQuery)) {
         delete results;
-        results = m_deinflection->search(query, preliminaryResults);
+        results = m_deinflection->search(query, m_edictFile, preliminaryResults);
         QString *label = m_deinflection->getDeinflectionLabel();
         if (!label->isEmpty() && !m_hasDeinflection) {
             deinflectionLabel = label;
@@ -142,54 +184,34 @@ EntryList *DictFileEdict::doSearch(const DictQuery &query)
     }
 
     if (results) {
-        auto common = new EntryList();
-        auto uncommon = new EntryList();
-        EntryList::EntryIterator i(*results);
-        while (i.hasNext()) {
-            auto entry = static_cast<EntryEdict *>(i.next());
-            if (entry->isCommon()) {
-                common->append(entry);
-            } else {
-                uncommon->append(entry);
+        // Group the results in place: exact matches first, then those beginning
+        // and ending with the word, then the rest. Common entries go first in
+        // each group. The entries stay in the arena of this list.
+        const QString word = query.getWord();
+        QList<QPair<int, Entry *>> ranked;
+        ranked.reserve(results->size());
+        for (Entry *entry : std::as_const(*results)) {
+            const QString entryWord = entry->getWord();
+            int rank = 6;
+            if (entryWord == word) {
+                rank = 0;
+            } else if (entryWord.startsWith(word)) {
+                rank = 2;
+            } else if (entryWord.endsWith(word)) {
+                rank = 4;
             }
-        }
-
-        delete results;
-        results = new EntryList();
-        results->appendList(common);
-        results->appendList(uncommon);
-        delete common;
-        delete uncommon;
-
-        auto exact = new EntryList();
-        auto beginning = new EntryList();
-        auto ending = new EntryList();
-        auto anywhere = new EntryList();
-        EntryList::EntryIterator it(*results);
-        while (it.hasNext()) {
-            Entry *entry = it.next();
-
-            if (entry->getWord() == query.getWord()) {
-                exact->append(entry);
-            } else if (entry->getWord().startsWith(query.getWord())) {
-                beginning->append(entry);
-            } else if (entry->getWord().endsWith(query.getWord())) {
-                ending->append(entry);
-            } else {
-                anywhere->append(entry);
+            if (!static_cast<EntryEdict *>(entry)->isCommon()) {
+                rank++;
             }
+            ranked.append(qMakePair(rank, entry));
         }
 
-        delete results;
-        results = new EntryList();
-        results->appendList(exact);
-        results->appendList(beginning);
-        results->appendList(ending);
-        results->appendList(anywhere);
-        delete exact;
-        delete beginning;
-        delete ending;
-        delete anywhere;
+        std::stable_sort(ranked.begin(), ranked.end(), [](const QPair<int, Entry *> &a, const QPair<int, Entry *> &b) {
+            return a.first < b.first;
+        });
+        for (int i = 0; i < ranked.size(); ++i) {
+            (*results)[i] = ranked.at(i).second;
+        }
     }
 
     return results;
@@ -216,11 +238,15 @@ bool DictFileEdict::loadDictionary(const QString &fileName, const QString &dictN
 
     if (m_edictFile.loadFile(fileName)) {
         m_dictionaryName = dictName;
+        m_dictionaryId = StringPool::dictionaries().intern(dictName);
         m_dictionaryFile = fileName;
 
-        m_deinflection = new Deinflection(m_dictionaryName);
+        m_deinflection = new Deinflection(m_dictionaryId);
         m_deinflection->load();
 
+        // Row ids refer to the lines of the file we just read
+        FragmentCache::self().clear();
+
         return true;
     }
 
@@ -263,6 +289,7 @@ QStringList *DictFileEdict::loadListType(KConfigSkeletonItem *item, QStringList
 void DictFileEdict::loadSettings()
 {
     this->displayFields = new QStringList(loadDisplayOptions().values());
+    displayTemplate.set(DisplayTemplate::compile(*displayFields, &Entry::fieldRenderer));
 }
 
 void DictFileEdict::loadSettings(KConfigSkeleton *config)
@@ -275,11 +302,14 @@ void DictFileEdict::loadSettings(KConfigSkeleton *config)
 
     KConfigSkeletonItem *item = config->findItem(getType() + "__displayFields"_L1);
     this->displayFields = loadListType(item, this->displayFields, long2short);
+    if (displayFields) {
+        displayTemplate.set(DisplayTemplate::compile(*displayFields, &Entry::fieldRenderer));
+    }
 }
 
-inline Entry *DictFileEdict::makeEntry(const QString &entry)
+inline Entry *DictFileEdict::makeEntry(EntryArena *arena, const QString &entry)
 {
-    return new EntryEdict(getName(), entry);
+    return arena->create<EntryEdict>(getDictionaryId(), entry);
 }
 
 DictionaryPreferenceDialog *DictFileEdict::preferencesWidget(KConfigSkeleton *config, QWidget *parent)
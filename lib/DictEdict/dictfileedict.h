@@ -12,6 +12,7 @@
 #define KITEN_DICTFILEEDICT_H
 
 #include "dictfile.h"
+#include "displaytemplate.h"
 #include "kiten_export.h"
 #include "linearedictfile.h"
 
@@ -34,7 +35,17 @@ public:
     DictFileEdict();
     ~DictFileEdict() override;
 
+    /**
+     * The words containing @p kanji, common words first and then ordered by word.
+     * This is looked up in an index, it does not scan the dictionary.
+     *
+     * @param kanji the code point of the kanji to find compounds of
+     * @param limit the maximum number of entries to return
+     * @param total if not null, set to the number of words containing the kanji
+     */
+    EntryList *compoundsForKanji(char32_t kanji, int limit, int *total = nullptr);
     EntryList *doSearch(const DictQuery &query) override;
+    Entry *entryForRow(EntryArena *arena, quint32 rowId) override;
     QStringList listDictDisplayOptions(QStringList x) const override;
     bool loadDictionary(const QString &file, const QString &name) override;
     void loadSettings();
@@ -50,11 +61,15 @@ protected:
     virtual QMap<QString, QString> displayOptions() const;
     QStringList *loadListType(KConfigSkeletonItem *item, QStringList *list, const QMap<QString, QString> &long2short);
     // This is a blatant abuse of protected methods to make the kanji subclass easy
-    virtual Entry *makeEntry(const QString &entry);
+    virtual Entry *makeEntry(EntryArena *arena, const QString &entry);
 
     LinearEdictFile m_edictFile;
 
     static QStringList *displayFields;
+    /**
+     * displayFields compiled by loadSettings()
+     */
+    static DisplayTemplate::Slot displayTemplate;
 
 private:
     QMap<QString, QString> loadDisplayOptions() const;
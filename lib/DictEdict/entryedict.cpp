@@ -12,11 +12,20 @@
 #include "dictfileedict.h"
 #include "kitenmacros.h"
 
-#include <QDebug>
+using namespace Qt::StringLiterals;
 
-#define QSTRINGLISTCHECK(x) (x == NULL ? QStringList() : *x)
+// Interned extended info keys, looked up once per process
+static StringPool::Atom commonKey()
+{
+    static const StringPool::Atom atom = StringPool::keys().intern(QStringLiteral("common"));
+    return atom;
+}
 
-using namespace Qt::StringLiterals;
+static StringPool::Atom fieldKey()
+{
+    static const StringPool::Atom atom = StringPool::keys().intern(QStringLiteral("field"));
+    return atom;
+}
 
 EntryEdict::EntryEdict(const QString &dict)
     : Entry(dict)
@@ -29,6 +38,12 @@ EntryEdict::EntryEdict(const QString &dict, const QString &entry)
     loadEntry(entry);
 }
 
+EntryEdict::EntryEdict(StringPool::Atom dict, const QString &entry)
+    : Entry(dict)
+{
+    loadEntry(entry);
+}
+
 Entry *EntryEdict::clone() const
 {
     return new EntryEdict(*this);
@@ -49,6 +64,11 @@ QString EntryEdict::getDictionaryType() const
     return EDICT;
 }
 
+quint32 EntryEdict::getDisplayVersion() const
+{
+    return DictFileEdict::displayTemplate.version();
+}
+
 QString EntryEdict::getTypes() const
 {
     return m_types.join(outputListDelimiter);
@@ -83,7 +103,7 @@ bool EntryEdict::isAdverb() const
 
 bool EntryEdict::isCommon() const
 {
-    return getExtendedInfoItem(QStringLiteral("common")) == QLatin1Char('1');
+    return getExtendedInfoItem(commonKey()) == QLatin1Char('1');
 }
 
 bool EntryEdict::isExpression() const
@@ -251,7 +271,7 @@ bool EntryEdict::loadEntry(const QString &entryLine)
     }
 
     if (Meanings.last() == QLatin1String("(P)")) {
-        ExtendedInfo[QStringLiteral("common")] = QStringLiteral("1");
+        ExtendedInfo[commonKey()] = QStringLiteral("1");
         Meanings.removeLast();
     }
 
@@ -269,7 +289,7 @@ bool EntryEdict::loadEntry(const QString &entryLine)
         if (EdictFormatting::PartsOfSpeech.contains(str)) {
             m_types += str;
         } else if (EdictFormatting::FieldOfApplication.contains(str)) {
-            ExtendedInfo[QStringLiteral("field")] = str;
+            ExtendedInfo[fieldKey()] = str;
         } else if (EdictFormatting::MiscMarkings.contains(str)) {
             m_miscMarkings += str;
         }
@@ -320,17 +340,8 @@ QString EntryEdict::toHTML() const
         result += QLatin1String("<div class=\"Common\">");
     }
 
-    for (const QString &field : QSTRINGLISTCHECK(DictFileEdict::displayFields)) {
-        if (field == QLatin1String("--NewLine--"))
-            result += QLatin1String("<br>");
-        else if (field == QLatin1String("Word/Kanji"))
-            result += HTMLWord() + ' '_L1;
-        else if (field == QLatin1String("Meaning"))
-            result += HTMLMeanings() + ' '_L1;
-        else if (field == QLatin1String("Reading"))
-            result += HTMLReadings() + ' '_L1;
-        else
-            qDebug() << "Unknown field: " << field;
+    if (const DisplayTemplate *displayTemplate = DictFileEdict::displayTemplate.get()) {
+        displayTemplate->render(*this, result);
     }
 
     if (isCommon()) {
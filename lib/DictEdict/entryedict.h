@@ -49,6 +49,7 @@ public:
     //     EntryEdict( const EntryEdict &x ) : Entry( x ) {} //No special members to copy in this one
     EntryEdict(const QString &dict);
     EntryEdict(const QString &dict, const QString &entry);
+    EntryEdict(StringPool::Atom dict, const QString &entry);
 
     Entry *clone() const override;
     /**
@@ -77,6 +78,7 @@ public:
 
     QString dumpEntry() const override;
     QString getDictionaryType() const override;
+    quint32 getDisplayVersion() const override;
     QString HTMLWord() const override;
     bool loadEntry(const QString &entryLine) override;
     QString toHTML() const override;
@@ -12,6 +12,8 @@
 #include <QFile>
 #include <QStringDecoder>
 
+#include <algorithm>
+
 using namespace Qt::StringLiterals;
 
 LinearEdictFile::LinearEdictFile()
@@ -22,18 +24,79 @@ LinearEdictFile::LinearEdictFile()
 /**
  * Get everything that looks remotely like a given search string
  */
-QList<QString> LinearEdictFile::findMatches(const QString &searchString) const
+QList<int> LinearEdictFile::findMatches(const QString &searchString) const
 {
-    QList<QString> matches;
-    for (const QString &it : m_edict) {
-        if (it.contains(searchString)) {
-            matches.append(it);
+    QList<int> matches;
+    for (int i = 0; i < m_edict.size(); ++i) {
+        if (m_edict.at(i).contains(searchString)) {
+            matches.append(i);
         }
     }
 
     return matches;
 }
 
+QString LinearEdictFile::line(int index) const
+{
+    return m_edict.value(index);
+}
+
+QList<int> LinearEdictFile::compoundsOf(char32_t kanji) const
+{
+    return m_compounds.value(kanji);
+}
+
+void LinearEdictFile::buildCompoundIndex()
+{
+    struct Line {
+        int index;
+        bool common;
+        QStringView word;
+    };
+
+    // Order every line once, then each kanji's postings come out ordered too
+    QList<Line> lines;
+    lines.reserve(m_edict.size());
+    for (int i = 0; i < m_edict.size(); ++i) {
+        const QString &text = m_edict.at(i);
+        const qsizetype endOfWord = text.indexOf(' '_L1);
+        if (endOfWord <= 0) {
+            continue;
+        }
+        // See EntryEdict::loadEntry(), "(P)" is always the last gloss
+        lines.append({i, text.contains("/(P)/"_L1), QStringView(text).left(endOfWord)});
+    }
+    std::stable_sort(lines.begin(), lines.end(), [](const Line &a, const Line &b) {
+        if (a.common != b.common) {
+            return a.common;
+        }
+        return a.word < b.word;
+    });
+
+    m_compounds.clear();
+    for (const Line &line : std::as_const(lines)) {
+        for (qsizetype i = 0; i < line.word.size(); ++i) {
+            // Kanji outside the BMP (CJK Extension B and later) take two code units
+            char32_t character = line.word.at(i).unicode();
+            if (QChar::isHighSurrogate(character) && i + 1 < line.word.size() && line.word.at(i + 1).isLowSurrogate()) {
+                character = QChar::surrogateToUcs4(line.word.at(i), line.word.at(i + 1));
+                ++i;
+            }
+            if (QChar::script(character) != QChar::Script_Han) {
+                continue;
+            }
+            QList<int> &postings = m_compounds[character];
+            // A word with the same kanji twice is only listed once
+            if (postings.isEmpty() || postings.last() != line.index) {
+                postings.append(line.index);
+            }
+        }
+    }
+    for (QList<int> &postings : m_compounds) {
+        postings.squeeze();
+    }
+}
+
 bool LinearEdictFile::loadFile(const QString &filename)
 {
     qDebug() << "Loading edict from " << filename;
@@ -61,6 +124,7 @@ bool LinearEdictFile::loadFile(const QString &filename)
     }
 
     file.close();
+    buildCompoundIndex();
     m_properlyLoaded = true;
 
     return true;
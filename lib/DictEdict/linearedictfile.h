@@ -9,6 +9,7 @@
 #ifndef KITEN_LINEAREDICTFILE_H
 #define KITEN_LINEAREDICTFILE_H
 
+#include <QHash>
 #include <QList>
 #include <QString>
 #include <QStringList>
@@ -37,12 +38,31 @@ public:
     bool valid() const;
 
     /**
-     * Get everything that looks remotely like a given search string
+     * Get everything that looks remotely like a given search string, as
+     * line numbers to pass to line()
      */
-    QList<QString> findMatches(const QString &searchString) const;
+    QList<int> findMatches(const QString &searchString) const;
+
+    /**
+     * The line at @p index in the dictionary, comments excluded
+     */
+    QString line(int index) const;
+
+    /**
+     * The lines whose word contains the code point @p kanji, common words
+     * first and then ordered by word. This comes from an index built when
+     * the file is loaded.
+     */
+    QList<int> compoundsOf(char32_t kanji) const;
 
 private:
+    void buildCompoundIndex();
+
     QStringList m_edict;
+    /**
+     * Kanji to the lines whose word contains it, see compoundsOf()
+     */
+    QHash<char32_t, QList<int>> m_compounds;
     bool m_properlyLoaded;
 };
 
@@ -11,8 +11,11 @@
 #include "dictfilekanjidic.h"
 
 #include "dictquery.h"
+#include "entryarena.h"
 #include "entrykanjidic.h"
 #include "entrylist.h"
+#include "fragmentcache.h"
+#include "kanjitable.h"
 #include "kitenmacros.h"
 
 #include <KConfigSkeleton>
@@ -22,9 +25,13 @@
 #include <QRegularExpression>
 #include <QStringDecoder>
 
+#include <algorithm>
+#include <limits>
+
 using namespace Qt::StringLiterals;
 
 QStringList *DictFileKanjidic::displayFields = nullptr;
+DisplayTemplate::Slot DictFileKanjidic::displayTemplate;
 
 DictFileKanjidic::DictFileKanjidic()
     : DictFile(KANJIDIC)
@@ -86,6 +93,22 @@ QMap<QString, QString> DictFileKanjidic::displayOptions() const
     return list;
 }
 
+Entry *DictFileKanjidic::entryForRow(EntryArena *arena, quint32 rowId)
+{
+    if (rowId == 0 || !m_validKanjidic) {
+        return nullptr;
+    }
+
+    const QString line = m_kanjidic.value(rowId - 1);
+    if (line.isEmpty()) {
+        return nullptr;
+    }
+
+    Entry *entry = makeEntry(arena, line);
+    entry->setRowId(rowId);
+    return entry;
+}
+
 EntryList *DictFileKanjidic::doSearch(const DictQuery &query)
 {
     if (query.isEmpty() || !m_validKanjidic) {
@@ -93,30 +116,71 @@ EntryList *DictFileKanjidic::doSearch(const DictQuery &query)
     }
 
     qDebug() << "Search from:" << getName();
-    QString searchQuery = query.getWord();
+
+    // Properties with an index narrow the search down to a set of lines,
+    // whatever is left of the query is checked on the entries
+    DictQuery remaining = query;
+    QBitArray candidates;
+    const QList<QString> properties = query.listPropertyKeys();
+    for (const QString &key : properties) {
+        QBitArray lines;
+        if (!linesWithAttribute(key, query.getProperty(key), lines)) {
+            continue;
+        }
+
+        remaining.takeProperty(key);
+        candidates = candidates.isNull() ? lines : candidates & lines;
+    }
+
+    // Exact kana lookups use the reading index, which also finds readings
+    // written with okurigana or in the other kana
+    if (remaining.getWord().isEmpty() && !remaining.getPronunciation().isEmpty() && remaining.getMatchType() == DictQuery::Exact) {
+        QBitArray lines(m_kanjidic.size(), true);
+        const QStringList readings = remaining.takePronunciation().split(DictQuery::mainDelimiter);
+        for (const QString &reading : readings) {
+            QBitArray rows(m_kanjidic.size());
+            for (int row : m_table->rowsWithReading(reading)) {
+                rows.setBit(row);
+            }
+            lines &= rows;
+        }
+        candidates = candidates.isNull() ? lines : candidates & lines;
+    }
+
+    QString searchQuery = remaining.getWord();
     if (searchQuery.length() == 0) {
-        searchQuery = query.getPronunciation();
+        searchQuery = remaining.getPronunciation();
         if (searchQuery.length() == 0) {
-            searchQuery = query.getMeaning().split(' '_L1).first().toLower();
+            searchQuery = remaining.getMeaning().split(' '_L1).first().toLower();
             if (searchQuery.length() == 0) {
-                QList<QString> keys = query.listPropertyKeys();
-                if (keys.empty()) {
+                QList<QString> keys = remaining.listPropertyKeys();
+                if (keys.empty() && candidates.isNull()) {
                     return new EntryList();
                 }
-                searchQuery = keys[0];
-                searchQuery = searchQuery + query.getProperty(searchQuery);
+                if (!keys.empty()) {
+                    searchQuery = keys[0];
+                    searchQuery = searchQuery + remaining.getProperty(searchQuery);
+                }
             }
         }
     }
 
     auto results = new EntryList();
-    for (const QString &line : m_kanjidic) {
-        if (line.contains(searchQuery)) {
-            Entry *entry = makeEntry(line);
-            if (entry->matchesQuery(query)) {
+    EntryArena *arena = results->arena();
+    const Entry::QueryProperties properties = Entry::queryProperties(remaining);
+    for (int i = 0; i < m_kanjidic.size(); ++i) {
+        if (!candidates.isNull() && !candidates.testBit(i)) {
+            continue;
+        }
+
+        const QString &line = m_kanjidic.at(i);
+        if (searchQuery.isEmpty() || line.contains(searchQuery)) {
+            Entry *entry = makeEntry(arena, line);
+            entry->setRowId(i + 1);
+            if (entry->matchesQuery(remaining, properties)) {
                 results->append(entry);
             } else
-                delete entry;
+                arena->discard(entry);
         }
     }
 
@@ -138,44 +202,100 @@ QStringList DictFileKanjidic::listDictDisplayOptions(QStringList list) const
     return list;
 }
 
-bool DictFileKanjidic::loadDictionary(const QString &file, const QString &name)
+bool DictFileKanjidic::linesWithAttribute(const QString &key, const QString &value, QBitArray &lines) const
 {
-    if (!m_kanjidic.isEmpty()) {
-        return true;
+    QString code = m_searchableAttributes.value(key, key);
+    bool numeric = false;
+    quint32 low = 0;
+    quint32 high = std::numeric_limits<quint32>::max();
+
+    if (key == "common"_L1) {
+        // Common kanji are the ones with a grade
+        code = QStringLiteral("G");
+        numeric = true;
+        low = 1;
+    } else {
+        const QStringList bounds = value.split('-'_L1);
+        if (bounds.size() <= 2 && !value.isEmpty() && value != "-"_L1) {
+            bool lowOk = bounds.first().isEmpty();
+            bool highOk = bounds.last().isEmpty();
+            if (!lowOk) {
+                low = bounds.first().toUInt(&lowOk);
+            }
+            if (!highOk) {
+                high = bounds.last().toUInt(&highOk);
+            }
+            numeric = lowOk && highOk;
+        }
     }
 
-    QFile dictionary(file);
-    if (!dictionary.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    const KanjiTable::AttributeIndex *index = m_table ? m_table->attributeIndex(code) : nullptr;
+    if (!index) {
         return false;
     }
 
-    qDebug() << "Loading kanjidic from:" << file;
+    lines = QBitArray(m_kanjidic.size());
+    if (numeric) {
+        auto it = std::lower_bound(index->numbers.cbegin(), index->numbers.cend(), qMakePair(low, 0));
+        for (; it != index->numbers.cend() && it->first <= high; ++it) {
+            lines.setBit(it->second);
+        }
+    } else {
+        for (int line : index->values.value(value)) {
+            lines.setBit(line);
+        }
+    }
 
-    QStringDecoder decoder("EUC-JP");
-    const QString decoded = decoder(dictionary.readAll());
+    return true;
+}
 
-    QTextStream fileStream(decoded.toUtf8());
+bool DictFileKanjidic::loadDictionary(const QString &file, const QString &name)
+{
+    if (!m_kanjidic.isEmpty()) {
+        return true;
+    }
 
-    QString currentLine;
-    while (!fileStream.atEnd()) {
-        currentLine = fileStream.readLine();
-        if (currentLine[0] != '#'_L1) {
-            m_kanjidic << currentLine;
-        }
+    // The table is shared with any other user of the same file
+    m_table = KanjiTable::load(file);
+    if (!m_table) {
+        return false;
     }
 
-    dictionary.close();
+    qDebug() << "Loading kanjidic from:" << file;
 
-    if (!validDictionaryFile(file)) {
+    m_validKanjidic = m_table->isValid();
+    if (!m_validKanjidic) {
+        m_table.reset();
         return false;
     }
+    m_kanjidic = m_table->lines();
 
     m_dictionaryName = name;
+    m_dictionaryId = StringPool::dictionaries().intern(name);
     m_dictionaryFile = file;
 
+    // Row ids refer to the lines of the file we just read
+    FragmentCache::self().clear();
+
     return true;
 }
 
+Entry *DictFileKanjidic::lookupKanji(EntryArena *arena, char32_t kanji)
+{
+    if (!m_validKanjidic || !m_table) {
+        return nullptr;
+    }
+
+    const int row = m_table->row(kanji);
+    if (row < 0) {
+        return nullptr;
+    }
+
+    Entry *entry = makeEntry(arena, m_kanjidic.at(row));
+    entry->setRowId(row + 1);
+    return entry;
+}
+
 QMap<QString, QString> DictFileKanjidic::loadDisplayOptions() const
 {
     QMap<QString, QString> list = displayOptions();
@@ -212,17 +332,21 @@ QStringList *DictFileKanjidic::loadListType(KConfigSkeletonItem *item, QStringLi
 void DictFileKanjidic::loadSettings()
 {
     this->displayFields = new QStringList(loadDisplayOptions().values());
+    displayTemplate.set(DisplayTemplate::compile(*displayFields, &EntryKanjidic::fieldRenderer));
 }
 
 void DictFileKanjidic::loadSettings(KConfigSkeleton *config)
 {
     KConfigSkeletonItem *item = config->findItem(getType() + "__displayFields"_L1);
     this->displayFields = loadListType(item, this->displayFields, loadDisplayOptions());
+    if (displayFields) {
+        displayTemplate.set(DisplayTemplate::compile(*displayFields, &EntryKanjidic::fieldRenderer));
+    }
 }
 
-inline Entry *DictFileKanjidic::makeEntry(const QString &entry)
+inline Entry *DictFileKanjidic::makeEntry(EntryArena *arena, const QString &entry)
 {
-    return new EntryKanjidic(getName(), entry);
+    return arena->create<EntryKanjidic>(getDictionaryId(), entry);
 }
 
 /**
@@ -12,9 +12,13 @@
 #define KITEN_DICTFILEKANJIDIC_H
 
 #include "dictfile.h"
+#include "displaytemplate.h"
+#include "kanjitable.h"
 
 #include "kiten_export.h"
 
+#include <QBitArray>
+#include <QHash>
 #include <QStringList>
 
 class DictQuery;
@@ -33,9 +37,16 @@ public:
 
     QMap<QString, QString> displayOptions() const;
     EntryList *doSearch(const DictQuery &query) override;
+    Entry *entryForRow(EntryArena *arena, quint32 rowId) override;
     QStringList dumpDictionary();
     QStringList listDictDisplayOptions(QStringList list) const override;
     bool loadDictionary(const QString &file, const QString &name) override;
+    /**
+     * The entry of a single kanji, created in @p arena, or nullptr if this
+     * dictionary does not list it. Unlike doSearch() this does not scan the
+     * dictionary, it looks the code point up in the KanjiTable.
+     */
+    Entry *lookupKanji(EntryArena *arena, char32_t kanji);
     QStringList *loadListType(KConfigSkeletonItem *item, QStringList *list, const QMap<QString, QString> &long2short);
     void loadSettings();
     void loadSettings(KConfigSkeleton *item) override;
@@ -43,13 +54,27 @@ public:
     bool validQuery(const DictQuery &query) override;
 
 protected:
-    virtual inline Entry *makeEntry(const QString &entry);
+    virtual inline Entry *makeEntry(EntryArena *arena, const QString &entry);
 
     static QStringList *displayFields;
+    /**
+     * displayFields compiled by loadSettings()
+     */
+    static DisplayTemplate::Slot displayTemplate;
 
 private:
+    /**
+     * Sets @p lines to the lines matching the property @p key : @p value.
+     * Numeric values may be a range like "5-8", "5-" or "-8". Returns false
+     * if the key is not indexed.
+     */
+    bool linesWithAttribute(const QString &key, const QString &value, QBitArray &lines) const;
     QMap<QString, QString> loadDisplayOptions() const;
 
+    /**
+     * The parsed file, m_kanjidic shares its lines
+     */
+    KanjiTable::Pointer m_table;
     QStringList m_kanjidic;
     bool m_validKanjidic;
 };
@@ -11,17 +11,50 @@
 #include "entrykanjidic.h"
 
 #include "dictfilekanjidic.h"
+#include "kanjidictokenizer.h"
 #include "kitenmacros.h"
 
 #include <KLocalizedString>
 
-#define QSTRINGLISTCHECK(x) (x == NULL ? QStringList() : *x)
+#include <algorithm>
+#include <iterator>
 
 using namespace Qt::StringLiterals;
 
+// The codes of the numeric slots, in the order of EntryKanjidic::NumericField
+static const char numericCodes[] = "BCEFGHJKLNSV";
+static constexpr int numericCodeCount = sizeof(numericCodes) - 1;
+
+/**
+ * The atoms of the keys entries compare against. They are interned when the
+ * library is loaded, so StringPool::keys().find() resolves them even for
+ * codes that only ever went to a numeric slot.
+ */
+static const struct KeyAtoms {
+    KeyAtoms()
+    {
+        StringPool &keys = StringPool::keys();
+        for (int slot = 0; slot < numericCodeCount; ++slot) {
+            numeric[slot] = keys.intern(QString(QLatin1Char(numericCodes[slot])));
+        }
+        common = keys.intern(QStringLiteral("common"));
+    }
+
+    StringPool::Atom numeric[numericCodeCount];
+    StringPool::Atom common;
+} keyAtoms;
+
 EntryKanjidic::EntryKanjidic(const EntryKanjidic &dict)
     : Entry(dict)
+    , AsRadicalReadings(dict.AsRadicalReadings)
+    , InNamesReadings(dict.InNamesReadings)
+    , KunyomiReadings(dict.KunyomiReadings)
+    , OnyomiReadings(dict.OnyomiReadings)
+    , originalReadings(dict.originalReadings)
+    , m_packedValues(dict.m_packedValues)
+    , m_packedFields(dict.m_packedFields)
 {
+    std::copy(std::begin(dict.m_numericFields), std::end(dict.m_numericFields), std::begin(m_numericFields));
 }
 
 EntryKanjidic::EntryKanjidic(const QString &dict)
@@ -35,6 +68,40 @@ EntryKanjidic::EntryKanjidic(const QString &dict, const QString &entry)
     loadEntry(entry);
 }
 
+EntryKanjidic::EntryKanjidic(StringPool::Atom dict, const QString &entry)
+    : Entry(dict)
+{
+    loadEntry(entry);
+}
+
+/**
+ * Stores one code of the entry line. The first numeric value of a code
+ * goes to its fixed slot, anything else is packed after the others.
+ */
+void EntryKanjidic::addField(QStringView key, QStringView value)
+{
+    const int slot = key.length() == 1 ? numericSlot(key.at(0)) : -1;
+    if (slot >= 0 && m_numericFields[slot] == 0) {
+        bool ok = false;
+        const uint number = value.toUInt(&ok);
+        if (ok && number > 0 && number <= 0xFFFF) {
+            m_numericFields[slot] = number;
+            return;
+        }
+    }
+
+    if (m_packedValues.length() + value.length() > 0xFFFF) {
+        return;
+    }
+
+    PackedField field;
+    field.key = slot >= 0 ? keyAtoms.numeric[slot] : StringPool::keys().intern(key.toString());
+    field.offset = m_packedValues.length();
+    field.length = value.length();
+    m_packedValues += value;
+    m_packedFields.append(field);
+}
+
 QString EntryKanjidic::addReadings(const QStringList &list) const
 {
     QString readings;
@@ -56,23 +123,50 @@ Entry *EntryKanjidic::clone() const
  */
 QString EntryKanjidic::dumpEntry() const
 {
-    /* Loop over the ExtendedInfo to add it to the line we produce */
+    /* Loop over the fields to add them to the line we produce */
     QString dumpExtendedInfo;
-    QHash<QString, QString>::const_iterator it;
-    for (it = ExtendedInfo.constBegin(); it != ExtendedInfo.constEnd(); ++it) {
-        dumpExtendedInfo += ' '_L1 + it.key() + it.value();
+    for (int slot = 0; slot < NumericFieldCount; ++slot) {
+        if (m_numericFields[slot] != 0) {
+            dumpExtendedInfo += QStringLiteral(" %1%2").arg(QLatin1Char(numericCodes[slot])).arg(m_numericFields[slot]);
+        }
+    }
+    const StringPool &keys = StringPool::keys();
+    for (const PackedField &field : m_packedFields) {
+        dumpExtendedInfo += ' '_L1 + keys.string(field.key);
+        dumpExtendedInfo += packedValue(field);
     }
 
     return QStringLiteral("%1 %2%3").arg(Word).arg(Readings.join(QLatin1Char(' '))).arg(dumpExtendedInfo);
 }
 
-bool EntryKanjidic::extendedItemCheck(const QString &key, const QString &value) const
+bool EntryKanjidic::extendedItemCheck(StringPool::Atom key, const QString &value) const
 {
-    if (key == QLatin1String("common")) {
-        return !getExtendedInfoItem(QStringLiteral("G")).isEmpty();
+    if (key == keyAtoms.common) {
+        return m_numericFields[FieldG] != 0 || hasField(keyAtoms.numeric[FieldG]);
+    }
+
+    // Numeric codes are compared as integers, without building any string
+    const int slot = numericSlot(key);
+    if (slot >= 0 && m_numericFields[slot] != 0) {
+        bool ok = false;
+        const uint number = value.toUInt(&ok);
+        if (ok && m_numericFields[slot] == number) {
+            return true;
+        }
+    }
+
+    // Codes that can appear several times match if any of their values does
+    bool found = slot >= 0 && m_numericFields[slot] != 0;
+    for (const PackedField &field : m_packedFields) {
+        if (field.key == key) {
+            if (packedValue(field) == value) {
+                return true;
+            }
+            found = true;
+        }
     }
 
-    return Entry::extendedItemCheck(key, value);
+    return !found && value.isEmpty();
 }
 
 QString EntryKanjidic::getAsRadicalReadings() const
@@ -90,6 +184,49 @@ QString EntryKanjidic::getDictionaryType() const
     return KANJIDIC;
 }
 
+quint32 EntryKanjidic::getDisplayVersion() const
+{
+    return DictFileKanjidic::displayTemplate.version();
+}
+
+QHash<QString, QString> EntryKanjidic::getExtendedInfo() const
+{
+    QHash<QString, QString> result;
+    for (int slot = 0; slot < NumericFieldCount; ++slot) {
+        if (m_numericFields[slot] != 0) {
+            result.insert(QString(QLatin1Char(numericCodes[slot])), QString::number(m_numericFields[slot]));
+        }
+    }
+
+    // Later values replace earlier ones, as they did when this was a plain hash
+    const StringPool &keys = StringPool::keys();
+    for (const PackedField &field : m_packedFields) {
+        result.insert(keys.string(field.key), packedValue(field).toString());
+    }
+
+    return result;
+}
+
+QString EntryKanjidic::getExtendedInfoItem(StringPool::Atom key) const
+{
+    if (key == StringPool::EmptyAtom) {
+        return QString();
+    }
+
+    for (auto it = m_packedFields.crbegin(); it != m_packedFields.crend(); ++it) {
+        if (it->key == key) {
+            return packedValue(*it).toString();
+        }
+    }
+
+    const int slot = numericSlot(key);
+    if (slot >= 0 && m_numericFields[slot] != 0) {
+        return QString::number(m_numericFields[slot]);
+    }
+
+    return QString();
+}
+
 QString EntryKanjidic::getInNamesReadings() const
 {
     return InNamesReadings.join(outputListDelimiter);
@@ -102,7 +239,17 @@ QStringList EntryKanjidic::getInNamesReadingsList() const
 
 QString EntryKanjidic::getKanjiGrade() const
 {
-    return getExtendedInfoItem(QStringLiteral("G"));
+    if (m_numericFields[FieldG] != 0) {
+        return QString::number(m_numericFields[FieldG]);
+    }
+
+    return getExtendedInfoItem(keyAtoms.numeric[FieldG]);
+}
+
+int EntryKanjidic::getNumericField(QChar code) const
+{
+    const int slot = numericSlot(code);
+    return slot >= 0 ? m_numericFields[slot] : 0;
 }
 
 QString EntryKanjidic::getKunyomiReadings() const
@@ -127,13 +274,39 @@ QStringList EntryKanjidic::getOnyomiReadingsList() const
 
 QString EntryKanjidic::getStrokesCount() const
 {
-    return getExtendedInfoItem(QStringLiteral("S"));
+    if (m_numericFields[FieldS] != 0) {
+        return QString::number(m_numericFields[FieldS]);
+    }
+
+    return getExtendedInfoItem(keyAtoms.numeric[FieldS]);
 }
 
-QString EntryKanjidic::HTMLExtendedInfo(const QString &field) const
+bool EntryKanjidic::hasField(StringPool::Atom key) const
 {
-    // qDebug() << field;
-    return QStringLiteral("<span class=\"ExtendedInfo\">%1: %2</span>").arg(field).arg(ExtendedInfo[field]);
+    if (key == StringPool::EmptyAtom) {
+        return false;
+    }
+
+    const int slot = numericSlot(key);
+    if (slot >= 0 && m_numericFields[slot] != 0) {
+        return true;
+    }
+
+    for (const PackedField &field : m_packedFields) {
+        if (field.key == key) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Prepares the extended info item @p key, called @p field, for output as HTML
+ */
+QString EntryKanjidic::HTMLExtendedInfo(const QString &field, StringPool::Atom key) const
+{
+    return QStringLiteral("<span class=\"ExtendedInfo\">%1: %2</span>").arg(field).arg(getExtendedInfoItem(key));
 }
 
 /**
@@ -168,248 +341,119 @@ QString EntryKanjidic::HTMLWord() const
  * Fill the fields of our Entry object appropriate to the given
  * entry line from Kanjidic.
  */
-/* TODO: Error checking */
 bool EntryKanjidic::loadEntry(const QString &entryLine)
 {
-    unsigned int length = entryLine.length();
-
-    /* The loop would be a bit faster if we first grabbed the kanji (2 bytes) and then the
-       space that follows, etc. for the fixed-space portion of the entries let's try that.
-       First the first 2 bytes are guaranteed to be our kanji.  The 3rd byte is a space.
-       The 4th through 7th are an ascii representation of the JIS code.  One more space
-       Currently, kana are not detected so readings are anything that is not otherwise
-       in the 8th position. */
-    Word = entryLine.left(1);
-    //	QString strjis = raw.mid( 2, 4 );
-
-    /* variables for the loop */
-    QChar ichar;
-    QString curString;
-
-/* we would need to do these exact things ... many times so here now. */
-#define INCI                                                                                                                                                   \
-    if (i < length) {                                                                                                                                          \
-        i++;                                                                                                                                                   \
-        ichar = entryLine.at(i);                                                                                                                               \
-    }
-#define LOADSTRING(stringToLoad)                                                                                                                               \
-    while (entryLine.at(i) != ' '_L1) {                                                                                                                        \
-        stringToLoad += entryLine.at(i);                                                                                                                       \
-        if (i < length)                                                                                                                                        \
-            i++;                                                                                                                                               \
-        else                                                                                                                                                   \
-            break;                                                                                                                                             \
-    }
+    KanjidicTokenizer tokenizer(entryLine);
+    KanjidicTokenizer::Token token;
+    // The type of the T1/T2 block we are in, 0 outside of one
+    int readingType = 0;
+
+    while (tokenizer.next(token)) {
+        if (token.type != KanjidicTokenizer::Reading) {
+            readingType = 0;
+        }
 
-    //	qDebug() << "LOADSTRING: '" << stringToLoad << "'";
-
-    /* We can start looping at 8 because we have guarantees about the initial
-       data.  This loop is used because the kanjidic format allows the data
-       to be in any order until the end of the line.  The format was designed
-       such that the data can be identified by the first byte. */
-    for (unsigned int i = 7; i < length - 1; i++) {
-        ichar = entryLine.at(i);
-
-        curString = QLatin1String("");
-        switch (ichar.unicode()) {
-        case ' ':
-            /* as far as I can tell, there is no real rule forcing only 1 space so
-                    there's not really any significance to them.  This block is not
-                    reached in kanjidic itself. */
+        switch (token.type) {
+        case KanjidicTokenizer::Kanji:
+            Word = token.value.toString();
             break;
-        case 'B':
-            /* the radical, or busyu, number */
-        case 'C':
-            /* the classical radical number, usually doesn't differ from busyu number */
-        case 'E':
-            /* Henshell's "A Guide To Remembering Japanese Characters" index number */
-        case 'F':
-            /* frequency ranking */
-        case 'G':
-            /* grade level Jouyou 1 - 6 or 8 for common use or 9 for Jinmeiyou */
-        case 'H':
-            /* number from Halpern's New Japanese-English Character Dictionary */
-        case 'K':
-            /* Gakken Kanji Dictionary index */
-        case 'L':
-            /* Heisig's "Remembering The Kanji" index */
-        case 'N':
-            /* number from Nelson's Modern Reader's Japanese-English Character Dictionary */
-        case 'O':
-            /* O'Neill's "Japanese Names" index number */
-        case 'P':
-            /* SKIP code ... #-#-# format */
-        case 'Q':
-            /* Four Corner codes, it seems, can be multiple though I'm tempted just to take the last one. */
-        case 'U':
-            /* unicode which we are ignoring as it is found in another way */
-        case 'V':
-            /* number from Haig's New Nelson Japanese-English Character Dictionary */
-        case 'W':
-            /* korean reading */
-        case 'X':
-            /* I don't entirely understand this field. */
-        case 'Y':
-            /* Pinyin reading */
-        case 'Z':
-            /* SKIP misclassifications */
-
-            /* All of the above are of the format <Char><Data> where <Char> is
-                    exactly 1 character. */
-            i++;
-            LOADSTRING(curString)
-            ExtendedInfo.insert(QString(ichar), curString);
-            break;
-        case 'I':
-            /* index codes for Spahn & Hadamitzky reference books we need the next
-                    char to know what to do with it. */
-            INCI if (ichar == 'N'_L1)
-            {
-                /* a Kanji & Kana book number */
-                LOADSTRING(curString)
-            }
-            else {/* The Kanji Dictionary number, we need the current ichar. */
-                  LOADSTRING(curString)} ExtendedInfo.insert('I'_L1 + QString(ichar), curString);
+        case KanjidicTokenizer::JisCode:
             break;
-        case 'M':
-            /* index and page numbers for Morohashi's Daikanwajiten 2 fields possible */
-            INCI if (ichar == 'N'_L1)
-            {
-                LOADSTRING(curString)
-                /* index number */
-            }
-            else if (ichar == 'P'_L1){
-                LOADSTRING(curString)
-                /* page number in volume.page format */
-            } ExtendedInfo.insert('M'_L1 + QString(ichar), curString);
-            break;
-        case 'S':
+        case KanjidicTokenizer::Field:
             /* stroke count: may be multiple.  In that case, first is actual, others common
                     miscounts */
-            i++;
-            if (!ExtendedInfo.contains(QStringLiteral("S"))) {
-                LOADSTRING(curString)
-                ExtendedInfo.insert(QString(ichar), curString);
+            if (token.code == u"S" && hasField(keyAtoms.numeric[FieldS])) {
+                addField(u"_S", token.value);
             } else {
-                LOADSTRING(curString)
-                ExtendedInfo.insert('_'_L1 + QString(ichar), curString);
+                addField(token.code, token.value);
             }
             break;
-        case 'D':
-            /* dictionary codes */
-            INCI LOADSTRING(curString) ExtendedInfo.insert('D'_L1 + QString(ichar), curString);
-            break;
-        case '{':
-            /* This should be starting with the first '{' character of a meaning section.
-                    Let us get take it to the last. */
-            INCI while (ichar != '}'_L1)
-            {
-                curString += ichar;
-                /* sanity */
-                if (i < length) {
-                    i++;
-                } else {
-                    break;
-                }
-                ichar = entryLine.at(i);
-            }
-            INCI
-                //           qDebug() << "Meaning's curString: '" << curString << "'";
-                Meanings.append(curString);
+        case KanjidicTokenizer::ReadingTypeMarker:
+            readingType = token.value.toInt();
             break;
-        case 'T': /* a reading that is used in names for T1, radical names for T2 */
-        {
-            i++;
-            LOADSTRING(curString)
-            // Get the type number (1 for T1, 2 for T2).
-            int type = curString.toInt();
-            bool finished = false;
-            while (!finished) {
-                // Skip all whitespaces.
-                INCI while (ichar == ' '_L1)
-                {
-                    INCI
-                }
-                // Check if the current character is Kana.
-                if (0x3040 <= ichar.unicode() && ichar.unicode() <= 0x30FF) {
-                    // Reset our variable and load it with
-                    // all available kana until we find a whitespace.
-                    curString = QLatin1String("");
-                    LOADSTRING(curString)
-                    switch (type) {
-                    case 1: // Special reading used in names.
-                        InNamesReadings.append(curString);
-                        break;
-                    case 2: // Reading as radical.
-                        AsRadicalReadings.append(curString);
-                        break;
-                    }
-                } else {
-                    // There are not more kana characters,
-                    // so we finish this loop for now.
-                    finished = true;
+        case KanjidicTokenizer::Reading: {
+            /* a reading that is used in names for T1, radical names for T2 */
+            if (readingType != 0 && token.value.at(0) != u'-') {
+                if (readingType == 1) {
+                    InNamesReadings.append(token.value.toString());
+                } else if (readingType == 2) {
+                    AsRadicalReadings.append(token.value.toString());
                 }
+                break;
             }
-            // Now 'i' points to a '{' character. We decrease its value
-            // so in the next loop we can reach the "case '{'" section.
-            i--;
-        } break;
-        case '-':
-            /* a reading that is only in postposition */
-            /* any of those 2 signals a reading is to ensue. */
-            LOADSTRING(curString)
-            originalReadings.append(curString);
+            readingType = 0;
+
+            const QString reading = token.value.toString();
+            originalReadings.append(reading);
 
             // If it is Hiragana (Kunyomi)
-            if (0x3040 <= ichar.unicode() && ichar.unicode() <= 0x309F) {
-                KunyomiReadings.append(curString);
+            const QChar first = reading.at(0);
+            if (0x3040 <= first.unicode() && first.unicode() <= 0x309F) {
+                KunyomiReadings.append(reading);
             }
             // If it is Katakana (Onyomi)
-            else if (0x30A0 <= ichar.unicode() && ichar.unicode() <= 0x30FF) {
-                OnyomiReadings.append(curString);
+            else if (0x30A0 <= first.unicode() && first.unicode() <= 0x30FF) {
+                OnyomiReadings.append(reading);
             }
 
-            curString = curString.remove('-'_L1).remove('.'_L1);
-            Readings.append(curString);
+            Readings.append(QString(reading).remove('-'_L1).remove('.'_L1));
             break;
-        default:
-            /* either a character we don't address or a problem...we should ignore it */
-            // 	  qDebug() << "hit default in kanji parser.  Unicode: '" << ichar.unicode() << "'";
-
-            /* This should detect unicode kana */
-            // Hiragana 0x3040 - 0x309F, Katakana: 0x30A0 - 0x30FF
-            if (0x3040 <= ichar.unicode() && ichar.unicode() <= 0x30FF) {
-                LOADSTRING(curString)
-                originalReadings.append(curString);
-
-                // If it is Hiragana (Kunyomi)
-                if (0x3040 <= ichar.unicode() && ichar.unicode() <= 0x309F) {
-                    KunyomiReadings.append(curString);
-                }
-                // If it is Katakana (Onyomi)
-                else if (0x30A0 <= ichar.unicode() && ichar.unicode() <= 0x30FF) {
-                    OnyomiReadings.append(curString);
-                }
+        }
+        case KanjidicTokenizer::Meaning:
+            Meanings.append(token.value.toString());
+            break;
+        }
+    }
 
-                curString = curString.remove('-'_L1).remove('.'_L1);
-                Readings.append(curString);
-                break;
-            }
-            /* if it's not a kana reading ... it is something unhandled ...
-               possibly a new field in kanjidic.  Let's treat it as the
-               oh-so-common <char><data> type of entry.  It could be hotly
-               debated what we should actually do about these. */
-            i++;
-            LOADSTRING(curString)
-            ExtendedInfo.insert(QString(ichar), curString);
+    return !Word.isEmpty();
+}
 
-            break;
+int EntryKanjidic::numericSlot(QChar code)
+{
+    switch (code.unicode()) {
+    case 'B':
+        return FieldB;
+    case 'C':
+        return FieldC;
+    case 'E':
+        return FieldE;
+    case 'F':
+        return FieldF;
+    case 'G':
+        return FieldG;
+    case 'H':
+        return FieldH;
+    case 'J':
+        return FieldJ;
+    case 'K':
+        return FieldK;
+    case 'L':
+        return FieldL;
+    case 'N':
+        return FieldN;
+    case 'S':
+        return FieldS;
+    case 'V':
+        return FieldV;
+    default:
+        return -1;
+    }
+}
+
+int EntryKanjidic::numericSlot(StringPool::Atom key)
+{
+    for (int slot = 0; slot < NumericFieldCount; ++slot) {
+        if (keyAtoms.numeric[slot] == key) {
+            return slot;
         }
     }
-    //   qDebug() << "Parsed: '"<<Word<<"' ("<<Readings.join("^")<<") \""<<
-    //   Meanings.join("|")<<"\ and " <<ExtendedInfo.keys() << " from :"<<entryLine<<endl;
 
-    return true;
+    return -1;
+}
+
+QStringView EntryKanjidic::packedValue(const PackedField &field) const
+{
+    return QStringView(m_packedValues).mid(field.offset, field.length);
 }
 
 QString EntryKanjidic::makeReadingLink(const QString &inReading) const
@@ -418,6 +462,37 @@ QString EntryKanjidic::makeReadingLink(const QString &inReading) const
     return QStringLiteral("<a href=\"%1\">%2</a>").arg(reading.remove('.'_L1).remove('-'_L1)).arg(inReading);
 }
 
+/**
+ * Numeric codes are sorted by their value instead of alphabetically
+ */
+bool EntryKanjidic::sortByField(const Entry &that, const QString &field) const
+{
+    const auto other = dynamic_cast<const EntryKanjidic *>(&that);
+    const int slot = field.length() == 1 ? numericSlot(field.at(0)) : -1;
+    if (other && slot >= 0 && m_numericFields[slot] != 0 && other->m_numericFields[slot] != 0) {
+        return m_numericFields[slot] < other->m_numericFields[slot];
+    }
+
+    return Entry::sortByField(that, field);
+}
+
+DisplayTemplate::Renderer EntryKanjidic::fieldRenderer(const QString &field)
+{
+    if (DisplayTemplate::Renderer renderer = Entry::fieldRenderer(field)) {
+        return renderer;
+    }
+
+    // Interning the code here means rendering only compares atoms
+    const StringPool::Atom key = StringPool::keys().intern(field);
+    return [key, field](const Entry &entry, QString &html) {
+        const auto &kanji = static_cast<const EntryKanjidic &>(entry);
+        if (kanji.hasField(key)) {
+            html += kanji.HTMLExtendedInfo(field, key);
+            html += ' '_L1;
+        }
+    };
+}
+
 /**
  * Returns a HTML version of an Entry
  */
@@ -425,18 +500,8 @@ QString EntryKanjidic::toHTML() const
 {
     QString result = QStringLiteral("<div class=\"KanjidicBrief\">");
 
-    for (const QString &field : QSTRINGLISTCHECK(DictFileKanjidic::displayFields)) {
-        // qDebug() << "Display: "<<field;
-        if (field == QLatin1String("--NewLine--"))
-            result += QLatin1String("<br>");
-        else if (field == QLatin1String("Word/Kanji"))
-            result += HTMLWord() + ' '_L1;
-        else if (field == QLatin1String("Meaning"))
-            result += HTMLMeanings() + ' '_L1;
-        else if (field == QLatin1String("Reading"))
-            result += HTMLReadings() + ' '_L1;
-        else if (ExtendedInfo.contains(field))
-            result += HTMLExtendedInfo(field) + ' '_L1;
+    if (const DisplayTemplate *displayTemplate = DictFileKanjidic::displayTemplate.get()) {
+        displayTemplate->render(*this, result);
     }
 
     result += QLatin1String("</div>");
@@ -10,6 +10,7 @@
 #ifndef KITEN_ENTRYKANJIDIC_H
 #define KITEN_ENTRYKANJIDIC_H
 
+#include "displaytemplate.h"
 #include "entry.h"
 
 #include "kiten_export.h"
@@ -24,17 +25,34 @@ public:
     EntryKanjidic(const EntryKanjidic &dict);
     explicit EntryKanjidic(const QString &dict);
     EntryKanjidic(const QString &dict, const QString &entry);
+    EntryKanjidic(StringPool::Atom dict, const QString &entry);
 
     Entry *clone() const override;
     QString dumpEntry() const override;
+    using Entry::extendedItemCheck;
+    bool extendedItemCheck(StringPool::Atom key, const QString &value) const override;
+    /**
+     * Returns the renderer of a display field for DisplayTemplate::compile(),
+     * any field besides the basic ones is an extended info code.
+     */
+    static DisplayTemplate::Renderer fieldRenderer(const QString &field);
     QString getAsRadicalReadings() const;
     QStringList getAsRadicalReadingsList() const;
     QString getDictionaryType() const override;
+    quint32 getDisplayVersion() const override;
+    QHash<QString, QString> getExtendedInfo() const override;
+    using Entry::getExtendedInfoItem;
+    QString getExtendedInfoItem(StringPool::Atom key) const override;
     QString getInNamesReadings() const;
     QStringList getInNamesReadingsList() const;
     QString getKanjiGrade() const;
     QString getKunyomiReadings() const;
     QStringList getKunyomiReadingsList() const;
+    /**
+     * The value of a numeric single letter code (B, C, F, G, S...),
+     * or 0 if this kanji does not have it.
+     */
+    int getNumericField(QChar code) const;
     QString getOnyomiReadings() const;
     QStringList getOnyomiReadingsList() const;
     QString getStrokesCount() const;
@@ -42,11 +60,11 @@ public:
     QString toHTML() const override;
 
 protected:
-    bool extendedItemCheck(const QString &key, const QString &value) const override;
-    virtual QString HTMLExtendedInfo(const QString &field) const;
+    virtual QString HTMLExtendedInfo(const QString &field, StringPool::Atom key) const;
     QString HTMLReadings() const override;
     QString HTMLWord() const override;
     virtual QString makeReadingLink(const QString &inReading) const;
+    bool sortByField(const Entry &that, const QString &field) const override;
 
     QStringList AsRadicalReadings;
     QStringList InNamesReadings;
@@ -55,7 +73,45 @@ protected:
     QStringList originalReadings;
 
 private:
+    /**
+     * The single letter codes that always hold a small number get a fixed slot
+     */
+    enum NumericField {
+        FieldB,
+        FieldC,
+        FieldE,
+        FieldF,
+        FieldG,
+        FieldH,
+        FieldJ,
+        FieldK,
+        FieldL,
+        FieldN,
+        FieldS,
+        FieldV,
+        NumericFieldCount
+    };
+
+    /**
+     * Everything else (and repeated values) is appended to m_packedValues
+     */
+    struct PackedField {
+        StringPool::Atom key;
+        quint16 offset;
+        quint16 length;
+    };
+
+    static int numericSlot(QChar code);
+    static int numericSlot(StringPool::Atom key);
+
     QString addReadings(const QStringList &list) const;
+    void addField(QStringView key, QStringView value);
+    bool hasField(StringPool::Atom key) const;
+    QStringView packedValue(const PackedField &field) const;
+
+    quint16 m_numericFields[NumericFieldCount] = {};
+    QString m_packedValues;
+    QList<PackedField> m_packedFields;
 };
 
 #endif
@@ -0,0 +1,102 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "kanjidictokenizer.h"
+
+static bool isKana(QChar ch)
+{
+    // Hiragana 0x3040 - 0x309F, Katakana: 0x30A0 - 0x30FF
+    return 0x3040 <= ch.unicode() && ch.unicode() <= 0x30FF;
+}
+
+KanjidicTokenizer::KanjidicTokenizer(QStringView line)
+    : m_line(line)
+{
+}
+
+bool KanjidicTokenizer::next(Token &token)
+{
+    const qsizetype length = m_line.size();
+    while (m_position < length && m_line.at(m_position) == u' ') {
+        ++m_position;
+    }
+    if (m_position >= length) {
+        return false;
+    }
+
+    const qsizetype start = m_position;
+    token.code = QStringView();
+
+    if (m_line.at(start) == u'{') {
+        const qsizetype end = m_line.indexOf(u'}', start + 1);
+        const qsizetype stop = end < 0 ? length : end;
+        token.type = Meaning;
+        token.value = m_line.sliced(start + 1, stop - start - 1);
+        m_position = end < 0 ? length : end + 1;
+        ++m_index;
+        return true;
+    }
+
+    qsizetype end = m_line.indexOf(u' ', start);
+    if (end < 0) {
+        end = length;
+    }
+    m_position = end;
+    const QStringView word = m_line.sliced(start, end - start);
+
+    switch (m_index++) {
+    case 0:
+        token.type = Kanji;
+        token.value = word;
+        return true;
+    case 1:
+        token.type = JisCode;
+        token.value = word;
+        return true;
+    default:
+        break;
+    }
+
+    const QChar first = word.at(0);
+    if (first == u'-' || isKana(first)) {
+        token.type = Reading;
+        token.value = word;
+        return true;
+    }
+
+    if (first == u'T' && word.size() > 1 && word.at(1).isDigit()) {
+        token.type = ReadingTypeMarker;
+        token.value = word.sliced(1);
+        return true;
+    }
+
+    token.type = Field;
+
+    // The I (Spahn & Hadamitzky), M (Morohashi) and D (dictionary) codes are
+    // named by their first two letters, IN, I4, MN, MP, DR and so on. Their
+    // value has always kept the second letter: DR has R1234, IN has N123.
+    if (word.size() > 1 && (first == u'I' || first == u'M' || first == u'D')) {
+        token.code = word.first(2);
+    } else {
+        token.code = word.first(1);
+    }
+    token.value = word.sliced(1);
+    return true;
+}
+
+QStringView KanjidicTokenizer::field(QStringView line, QStringView code)
+{
+    KanjidicTokenizer tokenizer(line);
+    Token token;
+    while (tokenizer.next(token)) {
+        if (token.type == Field && token.code == code) {
+            return token.value;
+        }
+    }
+
+    return QStringView();
+}
@@ -0,0 +1,85 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KITEN_KANJIDICTOKENIZER_H
+#define KITEN_KANJIDICTOKENIZER_H
+
+#include <QStringView>
+
+#include "kiten_export.h"
+
+/**
+ * Splits a KANJIDIC line into its parts without copying anything, the
+ * tokens are views into the line. A line looks like
+ *
+ * 亜 3021 U4e9c B1 C7 G8 S7 ... ア つ.ぐ T1 つぎ {Asia} {rank next}
+ *
+ * that is the kanji, its JIS code, then codes, readings and meanings in any
+ * order. Codes are one letter followed by their value. The I, M and D codes
+ * are named by their first two letters instead, like IN, MP or DR, and their
+ * value starts with the second letter, as Entry::getExtendedInfo() has
+ * always shown them (DR: R1234). Malformed input never reads past the end
+ * of the line, a meaning without its closing brace simply runs to the end.
+ */
+class KITEN_EXPORT KanjidicTokenizer
+{
+public:
+    enum TokenType {
+        /**
+         * The kanji itself, always the first token
+         */
+        Kanji,
+        /**
+         * The JIS code, always the second token
+         */
+        JisCode,
+        /**
+         * A code, with its name in code and its value in value
+         */
+        Field,
+        /**
+         * A reading, starting with kana or '-'
+         */
+        Reading,
+        /**
+         * T1 or T2, the readings following it are used in names (1) or
+         * as a radical (2). value holds the number.
+         */
+        ReadingTypeMarker,
+        /**
+         * A meaning, without its braces
+         */
+        Meaning
+    };
+
+    struct Token {
+        TokenType type;
+        QStringView code;
+        QStringView value;
+    };
+
+    explicit KanjidicTokenizer(QStringView line);
+
+    /**
+     * Reads the next token, returns false at the end of the line
+     */
+    bool next(Token &token);
+
+    /**
+     * The value of the first @p code field of @p line, or an empty view.
+     * Handy when only one or two codes are needed, like the grade or the
+     * stroke count.
+     */
+    static QStringView field(QStringView line, QStringView code);
+
+private:
+    QStringView m_line;
+    qsizetype m_position = 0;
+    int m_index = 0;
+};
+
+#endif
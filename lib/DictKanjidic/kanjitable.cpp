@@ -0,0 +1,280 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "kanjitable.h"
+
+#include "kanjidictokenizer.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QStringDecoder>
+
+#include <algorithm>
+#include <limits>
+
+template<typename T>
+static T clamped(QStringView value)
+{
+    const uint number = value.toUInt();
+    return number > std::numeric_limits<T>::max() ? 0 : T(number);
+}
+
+KanjiTable::Pointer KanjiTable::load(const QString &file)
+{
+    static QMutex lock;
+    // Weak, a table goes away with the last dictionary or tool using it
+    static QHash<QString, QWeakPointer<const KanjiTable>> tables;
+
+    const QDateTime lastModified = QFileInfo(file).lastModified();
+
+    QMutexLocker locker(&lock);
+    Pointer table = tables.value(file).toStrongRef();
+    if (table && table->m_lastModified == lastModified) {
+        return table;
+    }
+
+    QFile dictionary(file);
+    if (!dictionary.open(QIODevice::ReadOnly)) {
+        tables.remove(file);
+        return Pointer();
+    }
+
+    qDebug() << "Parsing kanjidic from:" << file;
+
+    QStringDecoder decoder("EUC-JP");
+    const QString decoded = decoder(dictionary.readAll());
+
+    QSharedPointer<KanjiTable> result(new KanjiTable);
+    result->m_lastModified = lastModified;
+    for (QStringView line : QStringView(decoded).split(u'\n')) {
+        if (line.endsWith(u'\r')) {
+            line.chop(1);
+        }
+        if (line.isEmpty() || line.at(0) == u'#') {
+            continue;
+        }
+        result->appendLine(line.toString());
+    }
+    result->sortAttributeIndex();
+
+    for (auto it = tables.begin(); it != tables.end();) {
+        it = it.value().isNull() ? tables.erase(it) : std::next(it);
+    }
+    tables.insert(file, result);
+    return result;
+}
+
+void KanjiTable::appendLine(const QString &line)
+{
+    char32_t codePoint = 0;
+    int grade = 0;
+    int strokes = 0;
+    int frequency = 0;
+    int radical = 0;
+    QStringList readings;
+    bool hasStrokes = false;
+    bool hasMeaning = false;
+    int tokens = 0;
+    // The type of the T1/T2 block we are in, 0 outside of one
+    int readingType = 0;
+
+    const int row = m_lines.size();
+    const auto addReading = [this, row](QStringView reading, ReadingType type) {
+        QList<int> &rows = m_readingIndex[type][normalizedReading(reading)];
+        if (rows.isEmpty() || rows.last() != row) {
+            rows.append(row);
+        }
+    };
+
+    KanjidicTokenizer tokenizer(line);
+    KanjidicTokenizer::Token token;
+    while (tokenizer.next(token)) {
+        ++tokens;
+        if (token.type != KanjidicTokenizer::Reading) {
+            readingType = 0;
+        }
+
+        switch (token.type) {
+        case KanjidicTokenizer::Kanji:
+            codePoint = token.value.at(0).unicode();
+            if (token.value.size() > 1 && token.value.at(0).isHighSurrogate()) {
+                codePoint = QChar::surrogateToUcs4(token.value.at(0), token.value.at(1));
+            }
+            break;
+        case KanjidicTokenizer::Field: {
+            // The first stroke count is the real one, others are miscounts
+            const bool miscount = token.code == u"S" && hasStrokes;
+            AttributeIndex &index = m_attributeIndex[miscount ? QStringLiteral("_S") : token.code.toString()];
+            bool ok = false;
+            const quint32 number = token.value.toUInt(&ok);
+            if (ok) {
+                index.numbers.append(qMakePair(number, row));
+            } else {
+                index.values[token.value.toString()].append(row);
+            }
+
+            if (token.code == u"G" && grade == 0) {
+                grade = clamped<quint8>(token.value);
+            } else if (token.code == u"S" && !hasStrokes) {
+                strokes = clamped<quint8>(token.value);
+                hasStrokes = true;
+            } else if (token.code == u"F" && frequency == 0) {
+                frequency = clamped<quint16>(token.value);
+            } else if (token.code == u"B" && radical == 0) {
+                radical = clamped<quint16>(token.value);
+            }
+            break;
+        }
+        case KanjidicTokenizer::ReadingTypeMarker:
+            readingType = token.value.toInt();
+            break;
+        case KanjidicTokenizer::Reading:
+            // Readings used in names or as a radical are not readings of the kanji
+            if (readingType == 0 || token.value.at(0) == u'-') {
+                readingType = 0;
+                readings.append(token.value.toString());
+                // Onyomi are in katakana, kunyomi in hiragana
+                const char16_t first = token.value.at(0).unicode();
+                addReading(token.value, 0x30A0 <= first && first <= 0x30FF ? OnReading : KunReading);
+            } else if (readingType == 1) {
+                addReading(token.value, NanoriReading);
+            }
+            break;
+        case KanjidicTokenizer::Meaning:
+            hasMeaning = true;
+            break;
+        case KanjidicTokenizer::JisCode:
+            break;
+        }
+    }
+
+    if (tokens < 3 || !hasMeaning) {
+        m_valid = false;
+    }
+
+    m_rows.insert(codePoint, row);
+    m_lines.append(line);
+    m_codePoints.append(codePoint);
+    m_grades.append(grade);
+    m_strokes.append(strokes);
+    m_frequencies.append(frequency);
+    m_radicals.append(radical);
+    m_readings.append(readings);
+}
+
+void KanjiTable::sortAttributeIndex()
+{
+    for (AttributeIndex &index : m_attributeIndex) {
+        std::sort(index.numbers.begin(), index.numbers.end());
+        index.numbers.squeeze();
+    }
+}
+
+const KanjiTable::AttributeIndex *KanjiTable::attributeIndex(const QString &code) const
+{
+    const auto index = m_attributeIndex.constFind(code);
+    return index == m_attributeIndex.constEnd() ? nullptr : &index.value();
+}
+
+int KanjiTable::size() const
+{
+    return m_lines.size();
+}
+
+int KanjiTable::row(char32_t kanji) const
+{
+    return m_rows.value(kanji, -1);
+}
+
+char32_t KanjiTable::codePoint(int row) const
+{
+    return m_codePoints.at(row);
+}
+
+QString KanjiTable::kanji(int row) const
+{
+    const char32_t codePoint = m_codePoints.at(row);
+    return QString::fromUcs4(&codePoint, 1);
+}
+
+int KanjiTable::grade(int row) const
+{
+    return m_grades.at(row);
+}
+
+int KanjiTable::strokes(int row) const
+{
+    return m_strokes.at(row);
+}
+
+int KanjiTable::frequency(int row) const
+{
+    return m_frequencies.at(row);
+}
+
+int KanjiTable::radical(int row) const
+{
+    return m_radicals.at(row);
+}
+
+QStringList KanjiTable::readings(int row) const
+{
+    return m_readings.at(row);
+}
+
+QList<int> KanjiTable::rowsWithReading(const QString &reading) const
+{
+    const QString normalized = normalizedReading(reading);
+    QList<int> rows;
+    for (const QHash<QString, QList<int>> &index : m_readingIndex) {
+        rows += index.value(normalized);
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    return rows;
+}
+
+QList<int> KanjiTable::rowsWithReading(const QString &reading, ReadingType type) const
+{
+    return m_readingIndex[type].value(normalizedReading(reading));
+}
+
+QString KanjiTable::normalizedReading(QStringView reading)
+{
+    QString normalized;
+    normalized.reserve(reading.size());
+    for (QChar ch : reading) {
+        const char16_t unicode = ch.unicode();
+        if (unicode == u'-' || unicode == u'.') {
+            continue;
+        }
+        // Katakana ァ to ヶ sit 0x60 above their hiragana
+        if (0x30A1 <= unicode && unicode <= 0x30F6) {
+            normalized.append(QChar(unicode - 0x60));
+        } else {
+            normalized.append(ch);
+        }
+    }
+    return normalized;
+}
+
+QString KanjiTable::line(int row) const
+{
+    return m_lines.at(row);
+}
+
+QStringList KanjiTable::lines() const
+{
+    return m_lines;
+}
+
+bool KanjiTable::isValid() const
+{
+    return m_valid && !m_lines.isEmpty();
+}
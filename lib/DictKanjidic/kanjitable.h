@@ -0,0 +1,146 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KITEN_KANJITABLE_H
+#define KITEN_KANJITABLE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSharedPointer>
+#include <QStringList>
+
+#include "kiten_export.h"
+
+/**
+ * The contents of a KANJIDIC file, parsed once and shared by everything
+ * that needs it at the same time: the kanji dictionary, the kanji browser
+ * and the radical selector. Each kanji is a row, the columns hold the values most
+ * tools need without having to parse the line again.
+ *
+ * A table never changes after it is loaded. When the file changes on disk
+ * the next load() parses it again, tables handed out before stay valid.
+ * A table lives as long as someone holds a Pointer to it.
+ */
+class KITEN_EXPORT KanjiTable
+{
+public:
+    typedef QSharedPointer<const KanjiTable> Pointer;
+
+    enum ReadingType {
+        OnReading,
+        KunReading,
+        /**
+         * Readings used in names, the T1 block
+         */
+        NanoriReading,
+        ReadingTypeCount
+    };
+
+    /**
+     * The rows on which each value of a code appears
+     */
+    struct AttributeIndex {
+        /**
+         * Numeric values with their row, sorted, for equality and range queries
+         */
+        QList<QPair<quint32, int>> numbers;
+        QHash<QString, QList<int>> values;
+    };
+
+    /**
+     * Returns the table of @p file, parsing it only if no table of the file
+     * is in use. Returns a null pointer if the file cannot be read.
+     */
+    static Pointer load(const QString &file);
+
+    int size() const;
+    /**
+     * The row of @p kanji, or -1 if the file does not list it
+     */
+    int row(char32_t kanji) const;
+
+    char32_t codePoint(int row) const;
+    QString kanji(int row) const;
+    /**
+     * The school grade, 0 if the kanji has none
+     */
+    int grade(int row) const;
+    /**
+     * The stroke count, not counting the common miscounts
+     */
+    int strokes(int row) const;
+    /**
+     * The frequency rank, 0 if the kanji has none
+     */
+    int frequency(int row) const;
+    /**
+     * The number of the (Bushu) radical
+     */
+    int radical(int row) const;
+    QStringList readings(int row) const;
+    /**
+     * The rows of the kanji with @p reading, of any type, in row order.
+     * The reading is compared after normalizedReading(), so ツグ, つぐ and
+     * つ.ぐ all find 継.
+     */
+    QList<int> rowsWithReading(const QString &reading) const;
+    /**
+     * The rows of the kanji with @p reading of @p type, in row order
+     */
+    QList<int> rowsWithReading(const QString &reading, ReadingType type) const;
+    /**
+     * @p reading without the okurigana dot and the prefix and suffix dashes,
+     * with katakana folded to hiragana
+     */
+    static QString normalizedReading(QStringView reading);
+    /**
+     * The index of the values of @p code, named the way KanjidicTokenizer
+     * names it (G, S, DR...), with repeated stroke counts under _S. Returns
+     * nullptr if no kanji has the code.
+     */
+    const AttributeIndex *attributeIndex(const QString &code) const;
+    /**
+     * The raw line of @p row
+     */
+    QString line(int row) const;
+    /**
+     * All raw lines, in row order
+     */
+    QStringList lines() const;
+
+    /**
+     * True if every line had the layout of a KANJIDIC entry: the kanji, its
+     * codes and at least one meaning.
+     */
+    bool isValid() const;
+
+private:
+    KanjiTable() = default;
+
+    void appendLine(const QString &line);
+    void sortAttributeIndex();
+
+    QDateTime m_lastModified;
+    QStringList m_lines;
+    QList<char32_t> m_codePoints;
+    QList<quint8> m_grades;
+    QList<quint8> m_strokes;
+    QList<quint16> m_frequencies;
+    QList<quint16> m_radicals;
+    QList<QStringList> m_readings;
+    /**
+     * For each reading type, the rows of each normalized reading
+     */
+    QHash<QString, QList<int>> m_readingIndex[ReadingTypeCount];
+    QHash<char32_t, int> m_rows;
+    QHash<QString, AttributeIndex> m_attributeIndex;
+    bool m_valid = true;
+};
+
+#endif
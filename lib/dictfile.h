@@ -9,6 +9,7 @@
 #define KITEN_DICTFILE_H
 
 #include "kiten_export.h"
+#include "stringpool.h"
 
 #include <QMap>
 #include <QStringList>
@@ -16,6 +17,7 @@
 class DictQuery;
 class DictionaryPreferenceDialog;
 class Entry;
+class EntryArena;
 class EntryList;
 class KConfig;
 class KConfigSkeleton;
@@ -91,6 +93,21 @@ public:
     {
         return loadDictionary(file, name);
     }
+    /**
+     * Load the entry on line @p rowId of the dictionary again, see Entry::getRowId().
+     * This is used to bring back entries that were only remembered by their handle.
+     * If you do not re-implement this method, entries of your dictionary can not be
+     * brought back and are kept in full instead.
+     *
+     * @param arena the arena to create the entry in
+     * @param rowId the row id of the entry, counting from 1
+     */
+    virtual Entry *entryForRow(EntryArena *arena, quint32 rowId)
+    {
+        Q_UNUSED(arena)
+        Q_UNUSED(rowId)
+        return nullptr;
+    }
     /**
      * Return a list of the fields that can be displayed, note the following
      * should probably always be returned: --NewLine--, Word/Kanji, Meaning,
@@ -131,6 +148,14 @@ public:
     {
         return m_dictionaryName;
     }
+    /**
+     * Returns the id of the dictionary name in StringPool::dictionaries(),
+     * this is what the Entry objects we create store.
+     */
+    StringPool::Atom getDictionaryId() const
+    {
+        return m_dictionaryId;
+    }
     /**
      * Returns the type of files this dictFile object deals with
      */
@@ -160,6 +185,10 @@ protected:
      * (fairly important)
      */
     QString m_dictionaryName;
+    /**
+     * The interned m_dictionaryName, set it together with the name.
+     */
+    StringPool::Atom m_dictionaryId = StringPool::EmptyAtom;
 
     /**
      * This is mostly a placeholder, but your class will get asked what file
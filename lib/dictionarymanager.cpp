@@ -12,6 +12,7 @@
 #include "dictionarypreferencedialog.h"
 #include "dictquery.h"
 #include "entry.h"
+#include "entryarena.h"
 #include "entrylist.h"
 #include "kitenmacros.h"
 
@@ -20,10 +21,13 @@
 
 #include <QString>
 
+#include <algorithm>
+
 /* Includes to handle various types of dictionaries
 IMPORTANT: To add a dictionary type, add the header file here and add it to the
  if statement under addDictionary() */
 #include "DictEdict/dictfileedict.h"
+#include "DictEdict/entryedict.h"
 #include "DictKanjidic/dictfilekanjidic.h"
 
 using namespace Qt::StringLiterals;
@@ -35,6 +39,11 @@ public:
      * List of dictionaries, indexed by name
      */
     QHash<QString, DictFile *> dictManagers;
+    /**
+     * The generation each dictionary was given when it was loaded
+     */
+    QHash<StringPool::Atom, quint32> generations;
+    quint32 lastGeneration = 0;
 };
 
 #if 0
@@ -106,6 +115,7 @@ bool DictionaryManager::addDictionary(const QString &file, const QString &name,
 
     qDebug() << "Dictionary Loaded : " << newDict->getName();
     d->dictManagers.insert(name, newDict);
+    d->generations.insert(newDict->getDictionaryId(), ++d->lastGeneration);
     return true;
 }
 
@@ -166,16 +176,18 @@ EntryList *DictionaryManager::doSearch(const DictQuery &query) const
 /**
  * For this case, we let polymorphism do most of the work. We assume that the user wants
  * to pare down the results, so we let the individual entry matching methods run over the
- * new query and accept (and copy) any of those that pass.
+ * new query and accept any of those that pass. Entries are immutable, so the new list
+ * shares them (and the arenas holding them) with the old one instead of copying them.
  */
 EntryList *DictionaryManager::doSearchInList(const DictQuery &query, const EntryList *list) const
 {
     auto ret = new EntryList();
+    ret->shareStorage(*list);
 
+    const Entry::QueryProperties properties = Entry::queryProperties(query);
     for (Entry *it : *list) {
-        if (it->matchesQuery(query)) {
-            Entry *x = it->clone();
-            ret->append(x);
+        if (it->matchesQuery(query, properties)) {
+            ret->append(it);
         }
     }
 
@@ -183,6 +195,122 @@ EntryList *DictionaryManager::doSearchInList(const DictQuery &query, const Entry
     return ret;
 }
 
+EntryList *DictionaryManager::compoundsForKanji(char32_t kanji, int limit, int *total) const
+{
+    auto ret = new EntryList();
+    int found = 0;
+
+    for (DictFile *dictionary : std::as_const(d->dictManagers)) {
+        if (dictionary->getType() != EDICT) {
+            continue;
+        }
+
+        int dictionaryTotal = 0;
+        EntryList *compounds = static_cast<DictFileEdict *>(dictionary)->compoundsForKanji(kanji, limit, &dictionaryTotal);
+        found += dictionaryTotal;
+        ret->appendList(compounds);
+        delete compounds;
+    }
+
+    // With more than one EDICT dictionary their words have to be merged again
+    if (ret->size() > limit || found > ret->size()) {
+        std::stable_sort(ret->begin(), ret->end(), [](const Entry *a, const Entry *b) {
+            const bool aCommon = static_cast<const EntryEdict *>(a)->isCommon();
+            const bool bCommon = static_cast<const EntryEdict *>(b)->isCommon();
+            if (aCommon != bCommon) {
+                return aCommon;
+            }
+            return a->getWord() < b->getWord();
+        });
+    }
+    while (ret->size() > limit) {
+        ret->removeLast();
+    }
+
+    if (total) {
+        *total = found;
+    }
+    return ret;
+}
+
+EntryList *DictionaryManager::lookupKanji(char32_t kanji) const
+{
+    auto ret = new EntryList();
+    EntryArena *arena = ret->arena();
+
+    for (DictFile *dictionary : std::as_const(d->dictManagers)) {
+        if (dictionary->getType() != KANJIDIC) {
+            continue;
+        }
+
+        if (Entry *entry = static_cast<DictFileKanjidic *>(dictionary)->lookupKanji(arena, kanji)) {
+            ret->append(entry);
+        }
+    }
+
+    return ret;
+}
+
+EntryList *DictionaryManager::lookupAllKanji(QStringView text) const
+{
+    auto ret = new EntryList();
+    EntryArena *arena = ret->arena();
+
+    QList<DictFileKanjidic *> kanjiDictionaries;
+    for (DictFile *dictionary : std::as_const(d->dictManagers)) {
+        if (dictionary->getType() == KANJIDIC) {
+            kanjiDictionaries.append(static_cast<DictFileKanjidic *>(dictionary));
+        }
+    }
+
+    QList<uint> seen;
+    const QList<uint> codePoints = text.toUcs4();
+    for (uint codePoint : codePoints) {
+        if (QChar::script(codePoint) != QChar::Script_Han || seen.contains(codePoint)) {
+            continue;
+        }
+        seen.append(codePoint);
+
+        for (DictFileKanjidic *dictionary : std::as_const(kanjiDictionaries)) {
+            if (Entry *entry = dictionary->lookupKanji(arena, codePoint)) {
+                ret->append(entry);
+            }
+        }
+    }
+
+    return ret;
+}
+
+EntryList *DictionaryManager::entriesFromHandles(const QList<EntryHandle> &handles) const
+{
+    auto ret = new EntryList();
+    EntryArena *arena = ret->arena();
+
+    // Handles of one dictionary usually come one after the other
+    StringPool::Atom dictionaryId = StringPool::EmptyAtom;
+    DictFile *dictionary = nullptr;
+    for (const EntryHandle &handle : handles) {
+        if (handle.dictionary != dictionaryId || !dictionary) {
+            dictionaryId = handle.dictionary;
+            dictionary = d->dictManagers.value(StringPool::dictionaries().string(dictionaryId));
+        }
+        if (!dictionary) {
+            continue;
+        }
+
+        if (Entry *entry = dictionary->entryForRow(arena, handle.row)) {
+            ret->append(entry);
+        }
+    }
+
+    return ret;
+}
+
+quint32 DictionaryManager::dictionaryGeneration(StringPool::Atom dictionary) const
+{
+    return d->generations.value(dictionary);
+}
+
 QMap<QString, QString> DictionaryManager::generateExtendedFieldsList()
 {
     QMap<QString, QString> result;
@@ -331,6 +459,7 @@ void DictionaryManager::removeAllDictionaries()
 {
     qDeleteAll(d->dictManagers);
     d->dictManagers.clear();
+    d->generations.clear();
 }
 
 /**
@@ -342,6 +471,9 @@ void DictionaryManager::removeAllDictionaries()
 bool DictionaryManager::removeDictionary(const QString &name)
 {
     DictFile *file = d->dictManagers.take(name);
+    if (file) {
+        d->generations.remove(file->getDictionaryId());
+    }
     delete file;
     return true;
 }
@@ -10,15 +10,18 @@
 #define KITEN_DICTIONARYMANAGER_H
 
 #include "kiten_export.h"
+#include "stringpool.h"
 
 #include <QMap>
 #include <QPair>
 #include <QStringList>
+#include <QStringView>
 
 class DictFile;
 class DictQuery;
 class DictionaryPreferenceDialog;
 class EntryList;
+struct EntryHandle;
 class KConfig;
 class KConfigSkeleton;
 class QWidget;
@@ -103,6 +106,46 @@ public:
      * @param list the list of results to search for the above query in
      */
     EntryList *doSearchInList(const DictQuery &query, const EntryList *list) const;
+    /**
+     * The words of the EDICT dictionaries that contain a given kanji, common words
+     * first and then ordered by word. Unlike an Anywhere search this uses an index
+     * built when the dictionaries are loaded.
+     *
+     * @param kanji the code point of the kanji to find compounds of
+     * @param limit the maximum number of entries to return
+     * @param total if not null, set to the number of words containing the kanji
+     */
+    EntryList *compoundsForKanji(char32_t kanji, int limit, int *total = nullptr) const;
+    /**
+     * The KANJIDIC entries of a single kanji, one per kanji dictionary that
+     * lists it. This is a lookup by code point and does not scan the
+     * dictionaries the way doSearch() does.
+     *
+     * @param kanji the code point of the kanji
+     */
+    EntryList *lookupKanji(char32_t kanji) const;
+    /**
+     * The KANJIDIC entries of every kanji in @p text, in the order they first
+     * appear, for instance all the kanji of a word in one call. Characters
+     * which are not kanji, or which no dictionary lists, are skipped.
+     */
+    EntryList *lookupAllKanji(QStringView text) const;
+    /**
+     * Load entries back from their handles, in the same order. Handles of
+     * dictionaries that are not open anymore are skipped.
+     *
+     * @param handles the handles, as given by Entry::getHandle()
+     */
+    EntryList *entriesFromHandles(const QList<EntryHandle> &handles) const;
+    /**
+     * A number that changes every time a dictionary is loaded, for instance
+     * after an update replaced its file. Handles taken under another
+     * generation may point at other entries now.
+     *
+     * @param dictionary the id of the dictionary, see Entry::getDictId()
+     * @return the generation, or 0 if no such dictionary is open
+     */
+    quint32 dictionaryGeneration(StringPool::Atom dictionary) const;
     /**
      * Get a list of all supported dictionary types. Useful for preference code
      */
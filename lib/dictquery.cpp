@@ -19,6 +19,8 @@ TODO: Add features to limit the number of hits on a per-search basis.
 
 #include <QString>
 
+#include <utility>
+
 class DictQuery::Private
 {
 public:
@@ -469,6 +471,12 @@ bool DictQuery::setPronunciation(const QString &newPronunciation)
     return true;
 }
 
+QString DictQuery::takePronunciation()
+{
+    d->entryOrder.removeAll(d->pronunciationMarker);
+    return std::exchange(d->pronunciation, QString());
+}
+
 QString DictQuery::getWord() const
 {
     return d->word;
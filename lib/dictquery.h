@@ -208,6 +208,10 @@ public:
      * Mutator for the Pronunciation field
      */
     bool setPronunciation(const QString &newPronunciation);
+    /**
+     * Returns and removes the Pronunciation field
+     */
+    QString takePronunciation();
     /**
      * Accessor for the Word/Kanji field (this is usually used for anything
      * containing kanji).
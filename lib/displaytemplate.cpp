@@ -0,0 +1,79 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "displaytemplate.h"
+
+#include <QAtomicInteger>
+#include <QDebug>
+
+using namespace Qt::StringLiterals;
+
+static QAtomicInteger<quint32> lastVersion;
+
+const DisplayTemplate *DisplayTemplate::Slot::get() const
+{
+    return m_current.loadAcquire();
+}
+
+quint32 DisplayTemplate::Slot::version() const
+{
+    const DisplayTemplate *current = m_current.loadAcquire();
+    return current ? current->m_version : 0;
+}
+
+void DisplayTemplate::Slot::set(const Pointer &displayTemplate)
+{
+    QMutexLocker locker(&m_lock);
+    // Readers may still hold the previous template, so it is kept around
+    if (displayTemplate && !m_published.contains(displayTemplate)) {
+        m_published.append(displayTemplate);
+    }
+    m_current.storeRelease(displayTemplate.data());
+}
+
+DisplayTemplate::Pointer DisplayTemplate::compile(const QStringList &fields, const FieldResolver &resolver)
+{
+    QSharedPointer<DisplayTemplate> result(new DisplayTemplate);
+    result->m_fields = fields;
+    result->m_version = lastVersion.fetchAndAddRelaxed(1) + 1;
+    result->m_renderers.reserve(fields.size());
+
+    for (const QString &field : fields) {
+        if (field == "--NewLine--"_L1) {
+            result->m_renderers.append([](const Entry &, QString &html) {
+                html += "<br>"_L1;
+            });
+            continue;
+        }
+
+        Renderer renderer = resolver ? resolver(field) : Renderer();
+        if (renderer) {
+            result->m_renderers.append(renderer);
+        } else {
+            qDebug() << "Unknown field: " << field;
+        }
+    }
+
+    return result;
+}
+
+QStringList DisplayTemplate::fields() const
+{
+    return m_fields;
+}
+
+void DisplayTemplate::render(const Entry &entry, QString &html) const
+{
+    for (const Renderer &renderer : m_renderers) {
+        renderer(entry, html);
+    }
+}
+
+quint32 DisplayTemplate::version() const
+{
+    return m_version;
+}
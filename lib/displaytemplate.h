@@ -0,0 +1,102 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KITEN_DISPLAYTEMPLATE_H
+#define KITEN_DISPLAYTEMPLATE_H
+
+#include <QAtomicPointer>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QStringList>
+
+#include <functional>
+
+#include "kiten_export.h"
+
+class Entry;
+
+/**
+ * The list of fields a dictionary type displays, compiled once into a list
+ * of renderers. Each renderer appends one field of an entry to the output,
+ * so rendering an entry does not look at the field names anymore.
+ *
+ * A compiled template never changes. When the settings change a new one is
+ * compiled and installed in a Slot, entries being rendered at that moment
+ * keep using the one they started with.
+ */
+class KITEN_EXPORT DisplayTemplate
+{
+public:
+    typedef std::function<void(const Entry &entry, QString &html)> Renderer;
+    /**
+     * Returns the renderer for a field name, or an empty Renderer if the
+     * entry type does not know the field
+     */
+    typedef std::function<Renderer(const QString &field)> FieldResolver;
+    typedef QSharedPointer<const DisplayTemplate> Pointer;
+
+    /**
+     * Holds the template currently in use by a dictionary type. Reading it
+     * takes no lock: the template is published through an atomic pointer,
+     * and the slot keeps every template it published alive until it goes
+     * away. Templates are only compiled when the settings change, so there
+     * are never more than a handful of them.
+     */
+    class KITEN_EXPORT Slot
+    {
+    public:
+        /**
+         * The current template, or nullptr if none was set yet. It stays
+         * valid for as long as the slot exists.
+         */
+        const DisplayTemplate *get() const;
+        /**
+         * The version of the current template, 0 if none was set yet
+         */
+        quint32 version() const;
+        void set(const Pointer &displayTemplate);
+
+    private:
+        QAtomicPointer<const DisplayTemplate> m_current;
+        /**
+         * Every template set so far, only touched by set()
+         */
+        QMutex m_lock;
+        QList<Pointer> m_published;
+    };
+
+    /**
+     * Compile @p fields, as stored in the display settings. "--NewLine--"
+     * is handled here, every other field is looked up with @p resolver.
+     * Unknown fields are reported once, and skipped.
+     */
+    static Pointer compile(const QStringList &fields, const FieldResolver &resolver);
+
+    /**
+     * Append every field of @p entry to @p html
+     */
+    void render(const Entry &entry, QString &html) const;
+    /**
+     * The fields this template was compiled from
+     */
+    QStringList fields() const;
+    /**
+     * A number that is different for every compiled template, to tell
+     * apart output rendered with older settings
+     */
+    quint32 version() const;
+
+private:
+    DisplayTemplate() = default;
+
+    QStringList m_fields;
+    QList<Renderer> m_renderers;
+    quint32 m_version = 0;
+};
+
+#endif
@@ -21,12 +21,19 @@ using namespace Qt::StringLiterals;
  * (particularly the sourceDictionary).
  */
 Entry::Entry()
+    : sourceDict(StringPool::EmptyAtom)
 {
     init();
 }
 
 Entry::Entry(const QString &sourceDictionary)
-    : sourceDict(sourceDictionary)
+    : sourceDict(StringPool::dictionaries().intern(sourceDictionary))
+{
+    init();
+}
+
+Entry::Entry(StringPool::Atom dictionaryId)
+    : sourceDict(dictionaryId)
 {
     init();
 }
@@ -35,7 +42,7 @@ Entry::Entry(const QString &sourceDictionary, const QString &word, const QString
     : Word(word)
     , Meanings(meanings)
     , Readings(reading)
-    , sourceDict(sourceDictionary)
+    , sourceDict(StringPool::dictionaries().intern(sourceDictionary))
 {
     init();
 }
@@ -46,11 +53,17 @@ Entry::Entry(const Entry &src)
     , Readings(src.Readings)
     , ExtendedInfo(src.ExtendedInfo)
     , sourceDict(src.sourceDict)
+    , rowId(src.rowId)
 {
     outputListDelimiter = src.outputListDelimiter;
 }
 
 bool Entry::extendedItemCheck(const QString &key, const QString &value) const
+{
+    return extendedItemCheck(StringPool::keys().find(key), value);
+}
+
+bool Entry::extendedItemCheck(StringPool::Atom key, const QString &value) const
 {
     return getExtendedInfoItem(key) == value;
 }
@@ -59,10 +72,35 @@ bool Entry::extendedItemCheck(const QString &key, const QString &value) const
  * Get the dictionary name that generated this Entry. I can't think of a reason to be changing this
  */
 QString Entry::getDictName() const
+{
+    return StringPool::dictionaries().string(sourceDict);
+}
+
+StringPool::Atom Entry::getDictId() const
 {
     return sourceDict;
 }
 
+quint32 Entry::getRowId() const
+{
+    return rowId;
+}
+
+void Entry::setRowId(quint32 id)
+{
+    rowId = id;
+}
+
+EntryHandle Entry::getHandle() const
+{
+    return {sourceDict, rowId};
+}
+
+quint32 Entry::getDisplayVersion() const
+{
+    return 0;
+}
+
 /**
  * Get the word from this Entry. If the entry is of type kanji/kana/meaning/etc, this will return
  * the kanji. If it is of kana/meaning/etc, it will return kana.
@@ -109,7 +147,14 @@ QStringList Entry::getReadingsList() const
  */
 QHash<QString, QString> Entry::getExtendedInfo() const
 {
-    return ExtendedInfo;
+    QHash<QString, QString> result;
+    result.reserve(ExtendedInfo.size());
+    const StringPool &keys = StringPool::keys();
+    for (auto it = ExtendedInfo.constBegin(); it != ExtendedInfo.constEnd(); ++it) {
+        result.insert(keys.string(it.key()), it.value());
+    }
+
+    return result;
 }
 
 /**
@@ -119,7 +164,17 @@ QHash<QString, QString> Entry::getExtendedInfo() const
  */
 QString Entry::getExtendedInfoItem(const QString &x) const
 {
-    return ExtendedInfo[x];
+    // find() does not grow the pool, a key nobody interned can not be in our hash
+    return getExtendedInfoItem(StringPool::keys().find(x));
+}
+
+QString Entry::getExtendedInfoItem(StringPool::Atom key) const
+{
+    if (key == StringPool::EmptyAtom) {
+        return QString();
+    }
+
+    return ExtendedInfo.value(key);
 }
 
 /**
@@ -236,6 +291,23 @@ inline QString Entry::makeLink(const QString &entryString) const
 }
 
 bool Entry::matchesQuery(const DictQuery &query) const
+{
+    return matchesQuery(query, queryProperties(query));
+}
+
+Entry::QueryProperties Entry::queryProperties(const DictQuery &query)
+{
+    QueryProperties properties;
+    const StringPool &keys = StringPool::keys();
+    const QList<QString> propList = query.listPropertyKeys();
+    for (const QString &key : propList) {
+        properties.append(qMakePair(keys.find(key), query.getProperty(key)));
+    }
+
+    return properties;
+}
+
+bool Entry::matchesQuery(const DictQuery &query, const QueryProperties &properties) const
 {
     if (!query.getWord().isEmpty()) {
         if (query.getMatchType() == DictQuery::Exact && this->getWord() != query.getWord()) {
@@ -290,9 +362,8 @@ bool Entry::matchesQuery(const DictQuery &query) const
         }
     }
 
-    QList<QString> propList = query.listPropertyKeys();
-    for (const QString &key : propList) {
-        if (!extendedItemCheck(key, query.getProperty(key))) {
+    for (const auto &property : properties) {
+        if (!extendedItemCheck(property.first, property.second)) {
             return false;
         }
     }
@@ -301,8 +372,30 @@ bool Entry::matchesQuery(const DictQuery &query) const
 }
 
 /**
- * Main switching function for displaying to the user
+ * Returns the renderer that displays one field of an entry
  */
+DisplayTemplate::Renderer Entry::fieldRenderer(const QString &field)
+{
+    if (field == QLatin1String("Word/Kanji")) {
+        return [](const Entry &entry, QString &html) {
+            html += entry.HTMLWord();
+            html += ' '_L1;
+        };
+    } else if (field == QLatin1String("Meaning")) {
+        return [](const Entry &entry, QString &html) {
+            html += entry.HTMLMeanings();
+            html += ' '_L1;
+        };
+    } else if (field == QLatin1String("Reading")) {
+        return [](const Entry &entry, QString &html) {
+            html += entry.HTMLReadings();
+            html += ' '_L1;
+        };
+    }
+
+    return {};
+}
+
 QString Entry::toHTML() const
 {
     return QStringLiteral("<div class=\"Entry\">%1%2%3</div>").arg(HTMLWord()).arg(HTMLReadings()).arg(HTMLMeanings());
@@ -342,13 +435,18 @@ QString Entry::toString() const
  * "this" should show up first on the list.
  */
 bool Entry::sort(const Entry &that, const QStringList &dictOrder, const QStringList &fields) const
+{
+    return sort(that, dictionaryIds(dictOrder), fields);
+}
+
+bool Entry::sort(const Entry &that, const QList<StringPool::Atom> &dictOrder, const QStringList &fields) const
 {
     if (this->sourceDict != that.sourceDict) {
-        for (const QString &dict : dictOrder) {
-            if (dict == that.sourceDict) {
+        for (const StringPool::Atom id : dictOrder) {
+            if (id == that.sourceDict) {
                 return false;
             }
-            if (dict == this->sourceDict) {
+            if (id == this->sourceDict) {
                 return true;
             }
         }
@@ -384,6 +482,18 @@ bool Entry::sort(const Entry &that, const QStringList &dictOrder, const QStringL
     return false; // If we reach here, they match as much as possible
 }
 
+QList<StringPool::Atom> Entry::dictionaryIds(const QStringList &names)
+{
+    QList<StringPool::Atom> ids;
+    ids.reserve(names.size());
+    const StringPool &dictionaries = StringPool::dictionaries();
+    for (const QString &name : names) {
+        ids.append(dictionaries.find(name));
+    }
+
+    return ids;
+}
+
 bool Entry::sortByField(const Entry &that, const QString &field) const
 {
     return this->getExtendedInfoItem(field) < that.getExtendedInfoItem(field);
@@ -12,20 +12,37 @@
 #define KITEN_ENTRY_H
 
 #include <QHash>
+#include <QPair>
 #include <QStringList>
 
 #include "kiten_export.h"
 
 #include "dictquery.h"
+#include "displaytemplate.h"
+#include "stringpool.h"
 
 class Entry;
 class EntryList;
 class QString;
 
+/**
+ * A compact reference to an entry of a dictionary: the dictionary id and the row id
+ * of the entry, see Entry::getRowId(). DictionaryManager::entriesFromHandles() loads
+ * the entries back.
+ */
+struct EntryHandle {
+    StringPool::Atom dictionary;
+    quint32 row;
+};
+
 /**
  * The Entry class is a generic base class for each particular entry in a given dictionary.
  * It's used as the basic class to ferry information back to the user application.
  * It also handles some of the display aspects.
+ *
+ * Entries are immutable once loaded: they are shared between an EntryList, the lists
+ * refined from it and the history, so they must not be modified in place. Use
+ * EntryList::detachEntry() to get a copy that can be edited.
  */
 class KITEN_EXPORT Entry
 {
@@ -50,6 +67,11 @@ protected:
      * @param sourceDictionary the dictionary name (not fileName) that this entry originated with
      */
     Entry(const QString &sourceDictionary);
+    /**
+     * Same as above, but with an already interned dictionary name
+     * @param dictionaryId the id of the dictionary in StringPool::dictionaries()
+     */
+    explicit Entry(StringPool::Atom dictionaryId);
     /**
      * A constructor that includes the basic information, nicely separated
      * @param sourceDictionary the dictionary name (not fileName) that this entry originated with
@@ -76,11 +98,49 @@ public:
      * cleanly.
      */
     virtual bool matchesQuery(const DictQuery &) const;
+    /**
+     * The property pairs of a query, with their keys resolved to atoms of StringPool::keys()
+     */
+    typedef QList<QPair<StringPool::Atom, QString>> QueryProperties;
+    /**
+     * Resolves the property keys of @p query. Searches do this once and pass
+     * the result to matchesQuery() for every entry.
+     */
+    static QueryProperties queryProperties(const DictQuery &query);
+    /**
+     * Same as matchesQuery(), with the properties of @p query already resolved
+     * by queryProperties()
+     */
+    bool matchesQuery(const DictQuery &query, const QueryProperties &properties) const;
 
     /**
      * Get the dictionary name that generated this Entry. I can't think of a reason to be changing this
      */
     QString getDictName() const;
+    /**
+     * Get the id of the dictionary that generated this Entry, as found in
+     * StringPool::dictionaries(). Comparing ids is cheaper than comparing names.
+     */
+    StringPool::Atom getDictId() const;
+    /**
+     * The line of the dictionary this entry was loaded from, counting from 1,
+     * or 0 if it does not come straight from a dictionary line (for instance
+     * once it was edited). Together with getDictId() it identifies the entry.
+     */
+    quint32 getRowId() const;
+    /**
+     * Set by the dictionary that creates the entry, see getRowId()
+     */
+    void setRowId(quint32 rowId);
+    /**
+     * The handle of this entry, only usable if getRowId() is not 0
+     */
+    EntryHandle getHandle() const;
+    /**
+     * The version of the DisplayTemplate toHTML() renders with, 0 if the
+     * entry type does not use one
+     */
+    virtual quint32 getDisplayVersion() const;
     /**
      * Get the dictionary type (e.g. edict, kanjidic).
      */
@@ -109,20 +169,37 @@ public:
     /**
      * Simple accessor
      */
-    QHash<QString, QString> getExtendedInfo() const;
+    virtual QHash<QString, QString> getExtendedInfo() const;
     /**
      * Simple accessor
      * @param x the key for the extended info item to get
      */
     QString getExtendedInfoItem(const QString &x) const;
+    /**
+     * Simple accessor, using an atom from StringPool::keys(). Entries that
+     * do not keep their extended info in the ExtendedInfo hash override this.
+     * @param key the key for the extended info item to get
+     */
+    virtual QString getExtendedInfoItem(StringPool::Atom key) const;
     /**
      * Simple accessor
      * @param key the key for the extended item that is being verified
      * @param value the value it is supposed to have
      * @returns true if the key has that value, false if it is different or does not exist
      */
-    virtual bool extendedItemCheck(const QString &key, const QString &value) const;
+    bool extendedItemCheck(const QString &key, const QString &value) const;
+    /**
+     * Same as above, using an atom from StringPool::keys(). Entries that do not
+     * keep their extended info in the ExtendedInfo hash override this.
+     */
+    virtual bool extendedItemCheck(StringPool::Atom key, const QString &value) const;
 
+    /**
+     * Returns the renderer of the fields every entry has, Word/Kanji, Meaning
+     * and Reading, for DisplayTemplate::compile(), or an empty renderer for
+     * any other field. Entry types with fields of their own fall back on this.
+     */
+    static DisplayTemplate::Renderer fieldRenderer(const QString &field);
     /**
      * An entry should be able to generate a representation of itself in (valid) HTML
      */
@@ -157,8 +234,23 @@ public:
      * @param fields the list of fields to sort in, uses special codes of
      *		        Reading, Meaning, Word/Kanji for those elements, all others by their
      *		        extended attribute keys.
+     *
+     * This looks the dictionary names up on every call, use the overload taking
+     * dictionary ids to compare many entries.
+     *
+     * EntryList::sort() does not call this per comparison, it resolves the same ordering
+     * from keys computed once per entry. Override sortByField() to customize it.
+     */
+    bool sort(const Entry &that, const QStringList &dictOrder, const QStringList &fields) const;
+    /**
+     * Same as above, with @p dictOrder already resolved to dictionary ids,
+     * see getDictId() and dictionaryIds()
      */
-    virtual bool sort(const Entry &that, const QStringList &dictOrder, const QStringList &fields) const;
+    virtual bool sort(const Entry &that, const QList<StringPool::Atom> &dictOrder, const QStringList &fields) const;
+    /**
+     * The ids of the dictionaries called @p names, in the same order
+     */
+    static QList<StringPool::Atom> dictionaryIds(const QStringList &names);
     /**
      * Overrideable sorting mechanism for sorting by individual fields.
      * The sort routine checks if the given field is equal, before calling this virtual function
@@ -186,14 +278,19 @@ protected:
      */
     QStringList Readings;
     /**
-     * A hash of extended information. You may find it useful to store all sorts of details here
+     * A hash of extended information. You may find it useful to store all sorts of details here.
+     * The keys are atoms from StringPool::keys()
      */
-    QHash<QString, QString> ExtendedInfo;
+    QHash<StringPool::Atom, QString> ExtendedInfo;
 
     /**
-     * The dictionary that this entry originated at
+     * The dictionary that this entry originated at, as an atom from StringPool::dictionaries()
+     */
+    StringPool::Atom sourceDict;
+    /**
+     * See getRowId()
      */
-    QString sourceDict;
+    quint32 rowId = 0;
     /**
      * The delimiter for lists... usually space
      */
@@ -0,0 +1,171 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "entryarena.h"
+
+#include "entry.h"
+
+#include <QList>
+#include <QSet>
+
+#include <algorithm>
+
+class EntryArena::Private
+{
+public:
+    struct Block {
+        char *data;
+        size_t size;
+        size_t used;
+    };
+
+    /**
+     * Enough room for a few hundred entries, so even large result sets
+     * only need a handful of allocations.
+     */
+    static constexpr size_t blockSize = 64 * 1024;
+
+    struct Range {
+        const char *begin;
+        const char *end;
+    };
+
+    QList<Block> blocks;
+    /**
+     * The address ranges of the blocks, sorted by address, for owns()
+     */
+    QList<Range> ranges;
+    /**
+     * Entries placed in the blocks, in the order they were created. This
+     * includes the discarded ones that were not the last one created, they
+     * are only destroyed with the arena.
+     */
+    QList<Entry *> entries;
+    /**
+     * Number of those entries that were discarded
+     */
+    int dead = 0;
+    /**
+     * Entries allocated elsewhere that we delete when we go away
+     */
+    QSet<Entry *> adopted;
+};
+
+EntryArena::EntryArena()
+    : d(new Private)
+{
+}
+
+EntryArena::~EntryArena()
+{
+    for (auto it = d->entries.crbegin(); it != d->entries.crend(); ++it) {
+        (*it)->~Entry();
+    }
+    qDeleteAll(d->adopted);
+    for (const Private::Block &block : std::as_const(d->blocks)) {
+        ::operator delete(block.data);
+    }
+
+    delete d;
+}
+
+Entry *EntryArena::adopt(Entry *entry)
+{
+    if (entry) {
+        d->adopted.insert(entry);
+    }
+
+    return entry;
+}
+
+void *EntryArena::allocate(size_t size, size_t alignment)
+{
+    if (!d->blocks.isEmpty()) {
+        Private::Block &block = d->blocks.last();
+        const size_t offset = (block.used + alignment - 1) & ~(alignment - 1);
+        if (offset + size <= block.size) {
+            block.used = offset + size;
+            return block.data + offset;
+        }
+    }
+
+    // ::operator new is suitably aligned for any Entry, so a fresh block starts at 0
+    Private::Block block;
+    block.size = qMax(Private::blockSize, size);
+    block.data = static_cast<char *>(::operator new(block.size));
+    block.used = size;
+    d->blocks.append(block);
+
+    const Private::Range range = {block.data, block.data + block.size};
+    const auto position = std::upper_bound(d->ranges.begin(), d->ranges.end(), range, [](const Private::Range &a, const Private::Range &b) {
+        return a.begin < b.begin;
+    });
+    d->ranges.insert(position, range);
+    return block.data;
+}
+
+int EntryArena::count() const
+{
+    return d->entries.size() - d->dead + d->adopted.size();
+}
+
+qint64 EntryArena::bytesAllocated() const
+{
+    qint64 bytes = 0;
+    for (const Private::Block &block : std::as_const(d->blocks)) {
+        bytes += block.size;
+    }
+
+    return bytes;
+}
+
+void EntryArena::discard(Entry *entry)
+{
+    if (!entry) {
+        return;
+    }
+
+    if (!d->entries.isEmpty() && d->entries.last() == entry) {
+        d->entries.removeLast();
+        entry->~Entry();
+        // The most recent allocation can simply be given back to the block
+        Private::Block &block = d->blocks.last();
+        const char *address = reinterpret_cast<const char *>(entry);
+        if (address >= block.data && address < block.data + block.size) {
+            block.used = static_cast<size_t>(address - block.data);
+        }
+        return;
+    }
+
+    if (d->adopted.remove(entry)) {
+        delete entry;
+        return;
+    }
+
+    // Looking an older entry up would be linear, it stays until the arena goes away
+    if (owns(entry)) {
+        d->dead++;
+    }
+}
+
+bool EntryArena::owns(const Entry *entry) const
+{
+    const char *address = reinterpret_cast<const char *>(entry);
+    auto range = std::upper_bound(d->ranges.cbegin(), d->ranges.cend(), address, [](const char *a, const Private::Range &b) {
+        return a < b.begin;
+    });
+    if (range != d->ranges.cbegin() && address < (--range)->end) {
+        return true;
+    }
+
+    return d->adopted.contains(const_cast<Entry *>(entry));
+}
+
+void EntryArena::registerEntry(Entry *entry)
+{
+    d->entries.append(entry);
+}
@@ -0,0 +1,78 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KITEN_ENTRYARENA_H
+#define KITEN_ENTRYARENA_H
+
+#include <QSharedData>
+
+#include <new>
+#include <utility>
+
+#include "kiten_export.h"
+
+class Entry;
+
+/**
+ * A monotonic buffer owning Entry objects. Entries are placed one after the
+ * other in large blocks instead of being allocated one by one, and they are
+ * all destroyed together when the arena goes away.
+ *
+ * Arenas are reference counted, EntryList keeps a reference to the arenas of
+ * the entries it holds, so an arena lives as long as a list refers to it.
+ */
+class KITEN_EXPORT EntryArena : public QSharedData
+{
+public:
+    EntryArena();
+    ~EntryArena();
+
+    /**
+     * Construct a new entry of type T inside the arena
+     */
+    template<typename T, typename... Args>
+    T *create(Args &&...args)
+    {
+        T *entry = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        registerEntry(entry);
+        return entry;
+    }
+    /**
+     * Take ownership of an entry that was allocated with new, for instance
+     * by Entry::clone(). It will be deleted with the arena.
+     */
+    Entry *adopt(Entry *entry);
+    /**
+     * Give back an entry of this arena, for candidates that turned out not
+     * to match. The last entry created is destroyed right away and its memory
+     * is reused, an older one is only destroyed with the arena.
+     */
+    void discard(Entry *entry);
+    /**
+     * Returns true if @p entry was created or adopted by this arena
+     */
+    bool owns(const Entry *entry) const;
+    /**
+     * Number of entries in the arena that were not discarded
+     */
+    int count() const;
+    /**
+     * Number of bytes reserved by the arena blocks
+     */
+    qint64 bytesAllocated() const;
+
+private:
+    Q_DISABLE_COPY(EntryArena)
+
+    void *allocate(size_t size, size_t alignment);
+    void registerEntry(Entry *entry);
+
+    class Private;
+    Private *const d;
+};
+
+#endif
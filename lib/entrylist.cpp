@@ -12,8 +12,15 @@
 
 #include <KLocalizedString>
 
+#include <QHash>
+#include <QSharedPointer>
+
+#include <algorithm>
+
 #include "DictEdict/dictfileedict.h"
 #include "DictEdict/entryedict.h"
+#include "entryarena.h"
+#include "fragmentcache.h"
 #include "kitenmacros.h"
 
 using namespace Qt::StringLiterals;
@@ -31,22 +38,168 @@ public:
     Private(const Private &other) = default;
     Private &operator=(const Private &other) = default;
 
+    /**
+     * Keep the arenas of @p other alive for as long as we are
+     */
+    void shareArenas(const Private &other)
+    {
+        for (const QExplicitlySharedDataPointer<EntryArena> &arena : other.arenas) {
+            if (!arenas.contains(arena)) {
+                arenas.append(arena);
+            }
+        }
+    }
+
+    /**
+     * Drop the rendered rows, the next render starts from scratch. Copies of
+     * the list that share them keep theirs.
+     */
+    void forgetRendering()
+    {
+        renderedRows.reset();
+    }
+
+    /**
+     * Drop row @p i and the row after it, whose headers depend on it.
+     * The other rows are copied so the lists we shared them with keep theirs.
+     */
+    void forgetRow(int i)
+    {
+        if (!renderedRows) {
+            return;
+        }
+
+        auto rows = QSharedPointer<QHash<int, RenderedRow>>::create(*renderedRows);
+        rows->remove(i);
+        rows->remove(i + 1);
+        renderedRows = rows;
+    }
+
+    bool ownsEntry(const Entry *entry) const
+    {
+        for (const QExplicitlySharedDataPointer<EntryArena> &arena : arenas) {
+            if (arena->owns(entry)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * The arena new entries for this list go to, it is also part of arenas
+     */
+    QExplicitlySharedDataPointer<EntryArena> arena;
+    /**
+     * Every arena holding entries of this list
+     */
+    QList<QExplicitlySharedDataPointer<EntryArena>> arenas;
+
+    struct RenderedRow {
+        quint32 displayVersion;
+        QString html;
+    };
+
+    /**
+     * The HTML of the rows rendered so far, with the headers before them.
+     * It is shared with the copies of the list (the history and the model
+     * of the view use copies), so going back to a list shows it without
+     * rendering it again.
+     */
+    QSharedPointer<QHash<int, RenderedRow>> renderedRows;
+
     int storedScrollValue;
     bool sorted;
     bool sortedByDictionary;
+    /**
+     * The orders the list was last sorted with
+     */
+    QStringList sortOrder;
+    QStringList dictionaryOrder;
     DictQuery query;
 };
 
-/* sorts the EntryList in a C++ish, thread-safe manner. */
-class SortFunctor
+/*
+ * Sorting is done decorate-sort-undecorate style: everything Entry::sort() would look up
+ * on every comparison (dictionary rank, field values) is resolved once per entry into a
+ * SortKey, and the keys are sorted instead. The comparison mirrors Entry::sort().
+ */
+class SortKey
 {
 public:
-    QStringList *dictionary_order;
-    QStringList *sort_order;
+    enum FieldType {
+        WordField,
+        MeaningField,
+        ReadingField,
+        ExtendedField
+    };
+
+    struct Field {
+        FieldType type;
+        QString name;
+        StringPool::Atom key;
+    };
+
+    Entry *entry;
+    StringPool::Atom dictionary;
+    int dictionaryRank;
+    QString word;
+    QStringList meanings;
+    QStringList readings;
+    QStringList values;
+};
 
-    bool operator()(const Entry *n1, const Entry *n2) const
+/* Returns true if all members of test are in list, see Entry::listMatch() */
+static bool containsAll(const QStringList &list, const QStringList &test)
+{
+    for (const QString &it : test) {
+        if (!list.contains(it)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+class SortKeyCompare
+{
+public:
+    const QList<SortKey::Field> *fields;
+
+    bool operator()(const SortKey &a, const SortKey &b) const
     {
-        return n1->sort(*n2, *dictionary_order, *sort_order);
+        if (a.dictionary != b.dictionary) {
+            return a.dictionaryRank < b.dictionaryRank;
+        }
+
+        int value = 0;
+        for (const SortKey::Field &field : *fields) {
+            switch (field.type) {
+            case SortKey::WordField:
+                return a.word < b.word;
+            case SortKey::MeaningField:
+                return containsAll(b.meanings, a.meanings) && a.meanings.count() != b.meanings.count();
+            case SortKey::ReadingField:
+                return containsAll(b.readings, a.readings) && a.readings.count() != b.readings.count();
+            case SortKey::ExtendedField: {
+                const QString &thisOne = a.values.at(value);
+                const QString &thatOne = b.values.at(value);
+                value++;
+                if (thisOne != thatOne) {
+                    if (thatOne.isEmpty()) {
+                        return true;
+                    }
+                    if (thisOne.isEmpty()) {
+                        return false;
+                    }
+                    // Keep the virtual hook, so dictionaries can still override sorting
+                    return a.entry->sortByField(*b.entry, field.name);
+                }
+                break;
+            }
+            }
+        }
+
+        return false;
     }
 };
 
@@ -78,41 +231,110 @@ void EntryList::setScrollValue(int val)
     d->storedScrollValue = val;
 }
 
+EntryArena *EntryList::arena()
+{
+    if (!d->arena) {
+        d->arena.reset(new EntryArena);
+        d->arenas.append(d->arena);
+    }
+
+    return d->arena.data();
+}
+
+void EntryList::shareStorage(const EntryList &other)
+{
+    d->shareArenas(*other.d);
+}
+
+Entry *EntryList::detachEntry(int i)
+{
+    Entry *entry = at(i);
+    // d->arena and its place in d->arenas are our own two references to it,
+    // any other one means another list can reach its entries
+    const bool arenaShared = !d->arena || d->arena->ref.loadRelaxed() != 2;
+    if (!arenaShared && d->arena->owns(entry)) {
+        // It is about to be edited, so it no longer matches its dictionary line
+        entry->setRowId(0);
+        d->forgetRow(i);
+        return entry;
+    }
+
+    // Copies go to an arena nobody else refers to, so editing them again
+    // changes them in place
+    if (arenaShared) {
+        d->arena.reset(new EntryArena);
+        d->arenas.append(d->arena);
+    }
+
+    Entry *copy = d->arena->adopt(entry->clone());
+    copy->setRowId(0);
+    replace(i, copy);
+    d->forgetRow(i);
+    return copy;
+}
+
 void EntryList::deleteAll()
 {
-    while (!this->isEmpty()) {
-        delete this->takeFirst();
+    // Entries living in our arenas go away with them, the others were made with new
+    for (Entry *entry : std::as_const(*this)) {
+        if (!d->ownsEntry(entry)) {
+            delete entry;
+        }
     }
+    clear();
 
+    d->arena.reset();
+    d->arenas.clear();
+    d->forgetRendering();
     d->sorted = false;
 }
 
 /* Returns the EntryList as HTML */
 // TODO: Some intelligent decision making regarding when to print what when AutoPrinting is on
 QString EntryList::toHTML(unsigned int start, unsigned int length) const
+{
+    QString result;
+    // A rough guess of the size of an entry, enough to avoid most reallocations
+    result.reserve(qMin<qsizetype>(length, size()) * 512);
+    appendHTML(result, start, length);
+    // result.replace( query, "<query>" + query + "</query>" );
+    return result;
+}
+
+void EntryList::appendHTML(QString &html, unsigned int start, unsigned int length) const
 {
     unsigned int max = count();
     if (start > max) {
-        return {};
+        return;
     }
     if (start + length > max) {
         length = max - start;
     }
 
-    QString result;
-    QString temp;
-    QString &lastDictionary = temp;
-    const QString fromDictionary = i18n("From Dictionary:");
-    QString query(getQuery());
-
-    bool firstTimeDeinflection = true;
-    bool firstTimeCommon = true;
-    bool firstTimeUncommon = true;
-    for (unsigned int i = 0; i < max; ++i) {
+    const bool commonUncommon = getQuery().getFilterType() == DictQuery::CommonUncommon;
+
+    // The headers only depend on the previous entry, so any window of the
+    // list can be rendered on its own without walking what comes before it.
+    if (!d->renderedRows) {
+        d->renderedRows.reset(new QHash<int, Private::RenderedRow>);
+    }
+
+    for (unsigned int i = start; i < start + length; ++i) {
         Entry *entry = at(i);
-        if (d->sortedByDictionary) {
-            const QString &newDictionary = entry->getDictName();
-            if (firstTimeDeinflection && newDictionary == EDICT && DictFileEdict::deinflectionLabel) {
+        const quint32 displayVersion = entry->getDisplayVersion();
+        const auto rendered = d->renderedRows->constFind(i);
+        if (rendered != d->renderedRows->constEnd() && rendered->displayVersion == displayVersion) {
+            html += rendered->html;
+            continue;
+        }
+
+        const qsizetype rowStart = html.size();
+        const Entry *previous = i > 0 ? at(i - 1) : nullptr;
+        const bool newDictionary = !previous || previous->getDictId() != entry->getDictId();
+
+        if (d->sortedByDictionary && newDictionary) {
+            const QString newDictionaryName = entry->getDictName();
+            if (newDictionaryName == EDICT && DictFileEdict::deinflectionLabel) {
                 const QString &label = *DictFileEdict::deinflectionLabel;
                 const QString &type = *DictFileEdict::wordType;
                 const QString &message = i18nc(
@@ -123,44 +345,47 @@ QString EntryList::toHTML(unsigned int start, unsigned int length) const
                     type,
                     label);
 
-                result += QStringLiteral("<div style=\"font-style:italic\">%1</div>").arg(message);
-
-                firstTimeDeinflection = false;
+                html += "<div style=\"font-style:italic\">"_L1;
+                html += message;
+                html += "</div>"_L1;
             }
 
-            if (lastDictionary != newDictionary) {
-                lastDictionary = newDictionary;
-                result += QStringLiteral("<div class=\"DictionaryHeader\">%1 %2</div>").arg(fromDictionary).arg(newDictionary);
-                firstTimeCommon = true;
-                firstTimeUncommon = true;
-            }
+            html += "<div class=\"DictionaryHeader\">"_L1;
+            html += i18n("From Dictionary:");
+            html += QLatin1Char(' ');
+            html += newDictionaryName;
+            html += "</div>"_L1;
         }
 
-        if (getQuery().getFilterType() == DictQuery::CommonUncommon) {
-            if (entry->getDictionaryType() == EDICT) {
-                auto entryEdict = static_cast<EntryEdict *>(entry);
-                if (entryEdict->isCommon() && firstTimeCommon) {
-                    result += QStringLiteral("<div class=\"CommonHeader\">%1</div>").arg(i18n("Common"));
-                    firstTimeCommon = false;
-                } else if (!entryEdict->isCommon() && firstTimeUncommon) {
-                    result += QStringLiteral("<div class=\"UncommonHeader\">%1</div>").arg(i18n("Uncommon"));
-                    firstTimeUncommon = false;
-                }
+        if (commonUncommon && entry->getDictionaryType() == EDICT) {
+            const bool common = static_cast<EntryEdict *>(entry)->isCommon();
+            // A header starts every run of common or uncommon entries
+            bool newRun = !previous || (d->sortedByDictionary && newDictionary) || previous->getDictionaryType() != EDICT;
+            if (!newRun) {
+                newRun = static_cast<const EntryEdict *>(previous)->isCommon() != common;
             }
-        }
 
-        if (length-- > 0) {
-            result += QStringLiteral("<div class=\"%1\" index=\"%2\" dict=\"%3\">%4</div>")
-                          .arg(i % 2 == 0 ? "Entry"_L1 : "Entry odd"_L1)
-                          .arg(QString::number(i))
-                          .arg(entry->getDictName())
-                          .arg(entry->toHTML());
-        } else {
-            break;
+            if (newRun && common) {
+                html += "<div class=\"CommonHeader\">"_L1;
+                html += i18n("Common");
+                html += "</div>"_L1;
+            } else if (newRun) {
+                html += "<div class=\"UncommonHeader\">"_L1;
+                html += i18n("Uncommon");
+                html += "</div>"_L1;
+            }
         }
+
+        html += i % 2 == 0 ? "<div class=\"Entry\" index=\""_L1 : "<div class=\"Entry odd\" index=\""_L1;
+        html += QString::number(i);
+        html += "\" dict=\""_L1;
+        html += entry->getDictName();
+        html += "\">"_L1;
+        html += FragmentCache::self().html(*entry);
+        html += "</div>"_L1;
+
+        d->renderedRows->insert(i, {displayVersion, html.mid(rowStart)});
     }
-    // result.replace( query, "<query>" + query + "</query>" );
-    return result;
 }
 
 QString EntryList::toKVTML(unsigned int start, unsigned int length) const
@@ -225,15 +450,73 @@ QString EntryList::toString() const
 
 void EntryList::sort(QStringList &sortOrder, QStringList &dictionaryOrder)
 {
-    // Don't shortcut sorting, unless we start to keep track of the last sorting order,
-    // Otherwise we won't respond when the user changes the sorting order
-    SortFunctor sorter;
-    sorter.dictionary_order = &dictionaryOrder;
-    sorter.sort_order = &sortOrder;
+    // Going back in the history sorts the same list again, keep the work
+    // (and what was rendered in that order) unless the sorting order changed
+    if (d->sorted && d->sortOrder == sortOrder && d->dictionaryOrder == dictionaryOrder) {
+        return;
+    }
+
+    // Only the fields up to the first Word/Meaning/Reading one can ever be compared
+    QList<SortKey::Field> fields;
+    for (const QString &name : std::as_const(sortOrder)) {
+        SortKey::Field field;
+        field.name = name;
+        field.key = StringPool::EmptyAtom;
+        if (name == QLatin1String("Word/Kanji")) {
+            field.type = SortKey::WordField;
+        } else if (name == QLatin1String("Meaning")) {
+            field.type = SortKey::MeaningField;
+        } else if (name == QLatin1String("Reading")) {
+            field.type = SortKey::ReadingField;
+        } else {
+            field.type = SortKey::ExtendedField;
+            field.key = StringPool::keys().find(name);
+        }
+        fields.append(field);
+        if (field.type != SortKey::ExtendedField) {
+            break;
+        }
+    }
+
+    QHash<StringPool::Atom, int> dictionaryRanks;
+    const StringPool &dictionaries = StringPool::dictionaries();
+    for (int i = dictionaryOrder.size() - 1; i >= 0; --i) {
+        dictionaryRanks.insert(dictionaries.find(dictionaryOrder.at(i)), i);
+    }
 
-    std::stable_sort(this->begin(), this->end(), sorter);
+    QList<SortKey> keys;
+    keys.reserve(size());
+    for (Entry *entry : std::as_const(*this)) {
+        SortKey key;
+        key.entry = entry;
+        key.dictionary = entry->getDictId();
+        key.dictionaryRank = dictionaryRanks.value(key.dictionary, dictionaryOrder.size());
+        for (const SortKey::Field &field : std::as_const(fields)) {
+            if (field.type == SortKey::WordField) {
+                key.word = entry->getWord();
+            } else if (field.type == SortKey::MeaningField) {
+                key.meanings = entry->getMeaningsList();
+            } else if (field.type == SortKey::ReadingField) {
+                key.readings = entry->getReadingsList();
+            } else if (field.type == SortKey::ExtendedField) {
+                key.values.append(entry->getExtendedInfoItem(field.key));
+            }
+        }
+        keys.append(key);
+    }
+
+    SortKeyCompare compare;
+    compare.fields = &fields;
+    std::stable_sort(keys.begin(), keys.end(), compare);
+
+    for (int i = 0; i < keys.size(); ++i) {
+        (*this)[i] = keys.at(i).entry;
+    }
+    d->forgetRendering();
     d->sorted = true;
     d->sortedByDictionary = !dictionaryOrder.empty();
+    d->sortOrder = sortOrder;
+    d->dictionaryOrder = dictionaryOrder;
 }
 
 const EntryList &EntryList::operator+=(const EntryList &other)
@@ -241,7 +524,9 @@ const EntryList &EntryList::operator+=(const EntryList &other)
     for (Entry *it : other) {
         this->append(it);
     }
+    d->shareArenas(*other.d);
     if (!other.empty()) {
+        d->forgetRendering();
         d->sorted = false;
     }
 
@@ -261,8 +546,10 @@ void EntryList::appendList(const EntryList *other)
     for (Entry *it : *other) {
         append(it);
     }
+    d->shareArenas(*other->d);
 
     if (!other->empty()) {
+        d->forgetRendering();
         d->sorted = false;
     }
 }
@@ -18,6 +18,8 @@
 #include "entry.h"
 #include "kiten_export.h"
 
+class EntryArena;
+
 /**
  * EntryList is a simple container for Entry objects, and is-a QList<Entry*>
  * A few simple overrides allow you to deal with sorting and translating.
@@ -39,16 +41,37 @@ public:
      */
     EntryList(const EntryList &old);
     /**
-     * Basic Destructor, does not delete Entry* objects. Please remember to call
-     * deleteAll() before deleting an EntryList.
+     * Basic Destructor. Entries living in an arena are released together with
+     * the last EntryList referring to that arena. Entry objects created with
+     * new are not deleted, please remember to call deleteAll() for those.
      */
     virtual ~EntryList();
     /**
-     * Delete all Entry objects in our list. In the future, we'll switch to a reference
-     * counting system, and this will be deprecated.
+     * Empty the list, releasing our arenas and deleting the Entry objects that
+     * were created with new.
      */
     void deleteAll();
 
+    /**
+     * The arena in which the Entry objects of this list should be created.
+     * It is shared with any list the entries are appended to, and released
+     * in one go when the last of them goes away.
+     */
+    EntryArena *arena();
+    /**
+     * Keep the arenas of @p other alive as long as this list. Entries are
+     * immutable, so once this is done they can be appended here without
+     * being copied.
+     */
+    void shareStorage(const EntryList &other);
+    /**
+     * Entries may be shared with other lists and must not be changed in
+     * place. This returns an Entry at position @p i that only this list
+     * refers to, replacing the shared one with a copy if needed. The
+     * returned entry has no row id anymore, see Entry::getRowId().
+     */
+    Entry *detachEntry(int i);
+
     /**
      * Convert every element of the EntryList to a QString and return it
      */
@@ -70,6 +93,15 @@ public:
      * @param length the length of the list we should generate
      */
     QString toHTML(unsigned int start, unsigned int length) const;
+    /**
+     * Append a given range of the EntryList in HTML form to @p html. Only
+     * the entries of the range are visited, so rendering a page of a large
+     * list costs the same as rendering a small list.
+     * @param html the buffer to append to, reserve it to avoid reallocations
+     * @param start the location in the list where we should start
+     * @param length the length of the list we should generate
+     */
+    void appendHTML(QString &html, unsigned int start, unsigned int length) const;
     /**
      * Convert the entire list to KVTML for export to a flashcard app
      * @param start the location in the list where we should start
@@ -88,6 +120,9 @@ public:
      *        a higher position) than an entry which does not have such an attribute.
      * @param dictionaryOrder the order for the Entry objects to be sorted in, dictionary-wise. This should
      *        match the names of the dictionary objects, passed to the DictionaryManager.
+     *
+     * Sorting a list again with the same orders does nothing, and keeps the rows
+     * toHTML() already rendered for it.
      */
     void sort(QStringList &sortOrder, QStringList &dictionaryOrder);
 
@@ -0,0 +1,134 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "fragmentcache.h"
+
+#include "entry.h"
+
+#include <QCache>
+#include <QHashFunctions>
+#include <QMutex>
+
+namespace
+{
+struct FragmentKey {
+    StringPool::Atom dictionary;
+    quint32 row;
+    quint32 version;
+
+    bool operator==(const FragmentKey &other) const
+    {
+        return dictionary == other.dictionary && row == other.row && version == other.version;
+    }
+};
+
+size_t qHash(const FragmentKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.dictionary, key.row, key.version);
+}
+}
+
+class FragmentCache::Private
+{
+public:
+    /**
+     * About 4 MiB, a few thousand entries
+     */
+    static constexpr qint64 defaultBudget = 4 * 1024 * 1024;
+
+    QMutex lock;
+    // The cost of a fragment is its size in bytes
+    QCache<FragmentKey, QString> fragments{defaultBudget};
+    quint64 hits = 0;
+    quint64 misses = 0;
+};
+
+FragmentCache::FragmentCache()
+    : d(new Private)
+{
+}
+
+FragmentCache::~FragmentCache()
+{
+    delete d;
+}
+
+FragmentCache &FragmentCache::self()
+{
+    static FragmentCache cache;
+    return cache;
+}
+
+QString FragmentCache::html(const Entry &entry)
+{
+    if (entry.getRowId() == 0) {
+        return entry.toHTML();
+    }
+
+    const FragmentKey key{entry.getDictId(), entry.getRowId(), entry.getDisplayVersion()};
+    {
+        QMutexLocker locker(&d->lock);
+        if (const QString *fragment = d->fragments.object(key)) {
+            ++d->hits;
+            return *fragment;
+        }
+        ++d->misses;
+    }
+
+    // Render without holding the lock, another thread may do the same
+    // entry meanwhile but that is harmless
+    const QString fragment = entry.toHTML();
+
+    QMutexLocker locker(&d->lock);
+    d->fragments.insert(key, new QString(fragment), fragment.size() * sizeof(QChar));
+    return fragment;
+}
+
+qint64 FragmentCache::byteBudget() const
+{
+    QMutexLocker locker(&d->lock);
+    return d->fragments.maxCost();
+}
+
+void FragmentCache::setByteBudget(qint64 bytes)
+{
+    QMutexLocker locker(&d->lock);
+    d->fragments.setMaxCost(bytes);
+}
+
+qint64 FragmentCache::bytesUsed() const
+{
+    QMutexLocker locker(&d->lock);
+    return d->fragments.totalCost();
+}
+
+quint64 FragmentCache::hits() const
+{
+    QMutexLocker locker(&d->lock);
+    return d->hits;
+}
+
+quint64 FragmentCache::misses() const
+{
+    QMutexLocker locker(&d->lock);
+    return d->misses;
+}
+
+double FragmentCache::hitRate() const
+{
+    QMutexLocker locker(&d->lock);
+    const quint64 lookups = d->hits + d->misses;
+    return lookups == 0 ? 0.0 : double(d->hits) / double(lookups);
+}
+
+void FragmentCache::clear()
+{
+    QMutexLocker locker(&d->lock);
+    d->fragments.clear();
+    d->hits = 0;
+    d->misses = 0;
+}
@@ -0,0 +1,65 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KITEN_FRAGMENTCACHE_H
+#define KITEN_FRAGMENTCACHE_H
+
+#include <QString>
+
+#include "kiten_export.h"
+
+class Entry;
+
+/**
+ * A process wide, least recently used cache of the HTML of entries. The
+ * same common words show up in result after result, this keeps their
+ * rendered form around.
+ *
+ * Fragments are keyed by the dictionary id and row id of the entry and by
+ * the version of the display template it was rendered with, so changing
+ * the display settings never shows stale output. Entries without a row id
+ * are rendered every time.
+ */
+class KITEN_EXPORT FragmentCache
+{
+public:
+    static FragmentCache &self();
+
+    /**
+     * Returns entry->toHTML(), from the cache if possible
+     */
+    QString html(const Entry &entry);
+
+    /**
+     * The number of bytes the cached fragments may use
+     */
+    qint64 byteBudget() const;
+    void setByteBudget(qint64 bytes);
+    /**
+     * The number of bytes the cached fragments use right now
+     */
+    qint64 bytesUsed() const;
+
+    quint64 hits() const;
+    quint64 misses() const;
+    /**
+     * Hits divided by lookups, 0 if there were none yet
+     */
+    double hitRate() const;
+
+    void clear();
+
+private:
+    FragmentCache();
+    ~FragmentCache();
+    Q_DISABLE_COPY(FragmentCache)
+
+    class Private;
+    Private *const d;
+};
+
+#endif
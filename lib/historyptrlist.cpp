@@ -8,23 +8,178 @@
 
 #include "historyptrlist.h"
 
+#include "dictionarymanager.h"
+#include "dictquery.h"
+#include "entry.h"
 #include "entrylist.h"
 
+#include <QHash>
 #include <QList>
 
 class HistoryPtrList::Private
 {
 public:
-    Private()
-        : index(-1)
-    {
-    }
+    struct Item {
+        DictQuery query;
+        /**
+         * The results, or nullptr while the item is reduced to handles
+         */
+        EntryList *list = nullptr;
+        QList<EntryHandle> handles;
+        /**
+         * The generation of each dictionary of handles, when they were taken
+         */
+        QHash<StringPool::Atom, quint32> generations;
+        int scrollValue = 0;
+        /**
+         * Estimated size of list, when it is there
+         */
+        qint64 listBytes = 0;
+
+        qint64 bytes() const
+        {
+            return sizeof(Item) + listBytes + handles.size() * qint64(sizeof(EntryHandle)) + generations.size() * qint64(2 * sizeof(quint32));
+        }
+    };
+
+    /**
+     * About what the old limit of 20 full lists used for ordinary searches
+     */
+    static constexpr qint64 defaultBudget = 16 * 1024 * 1024;
+
+    static qint64 estimateBytes(const EntryList *list);
+    static void deleteList(Item &item);
 
-    static const int max_size = 20;
-    int index;
-    QList<EntryList *> list;
+    /**
+     * Replace the list of @p item by the handles of its entries, if every entry has one
+     */
+    bool reduce(Item &item) const;
+    /**
+     * Load the entries of @p item back from its handles, or search again if a
+     * dictionary was loaded again since they were taken
+     */
+    void restore(Item &item) const;
+    /**
+     * Reduce or drop items, starting with the oldest, until we are within the budget.
+     * The current item is always kept as it is.
+     */
+    void enforceBudget();
+    qint64 totalBytes() const;
+
+    const DictionaryManager *manager = nullptr;
+    qint64 budget = defaultBudget;
+    int index = -1;
+    QList<Item> list;
 };
 
+qint64 HistoryPtrList::Private::estimateBytes(const EntryList *list)
+{
+    // The entry object with its strings and hashes, roughly
+    qint64 bytes = sizeof(EntryList) + list->size() * qint64(sizeof(Entry *));
+    for (const Entry *entry : *list) {
+        bytes += 256 + 2 * (entry->getWord().size() + entry->getReadings().size() + entry->getMeanings().size());
+    }
+
+    return bytes;
+}
+
+void HistoryPtrList::Private::deleteList(Item &item)
+{
+    if (item.list) {
+        item.list->deleteAll();
+        delete item.list;
+        item.list = nullptr;
+        item.listBytes = 0;
+    }
+}
+
+bool HistoryPtrList::Private::reduce(Item &item) const
+{
+    if (!item.list || !manager) {
+        return false;
+    }
+
+    QList<EntryHandle> handles;
+    QHash<StringPool::Atom, quint32> generations;
+    handles.reserve(item.list->size());
+    for (const Entry *entry : std::as_const(*item.list)) {
+        if (entry->getRowId() == 0) {
+            return false;
+        }
+        handles.append(entry->getHandle());
+        if (!generations.contains(entry->getDictId())) {
+            generations.insert(entry->getDictId(), manager->dictionaryGeneration(entry->getDictId()));
+        }
+    }
+
+    item.handles = handles;
+    item.generations = generations;
+    item.scrollValue = item.list->scrollValue();
+    deleteList(item);
+    return true;
+}
+
+void HistoryPtrList::Private::restore(Item &item) const
+{
+    if (item.list || !manager) {
+        return;
+    }
+
+    bool current = true;
+    for (auto it = item.generations.cbegin(); it != item.generations.cend(); ++it) {
+        if (manager->dictionaryGeneration(it.key()) != it.value()) {
+            current = false;
+            break;
+        }
+    }
+
+    if (current) {
+        item.list = manager->entriesFromHandles(item.handles);
+        item.list->setScrollValue(item.scrollValue);
+    } else {
+        // The rows may hold other entries now
+        item.list = manager->doSearch(item.query);
+    }
+    item.list->setQuery(item.query);
+    item.listBytes = estimateBytes(item.list);
+    item.handles.clear();
+    item.generations.clear();
+}
+
+qint64 HistoryPtrList::Private::totalBytes() const
+{
+    qint64 total = 0;
+    for (const Item &item : list) {
+        total += item.bytes();
+    }
+
+    return total;
+}
+
+void HistoryPtrList::Private::enforceBudget()
+{
+    qint64 total = totalBytes();
+
+    // First the lists of the items we are not looking at, oldest first
+    for (int i = 0; i < list.size() && total > budget; ++i) {
+        if (i == index || !list.at(i).list) {
+            continue;
+        }
+        const qint64 before = list.at(i).bytes();
+        if (reduce(list[i])) {
+            total += list.at(i).bytes() - before;
+        }
+    }
+
+    // Then the oldest items themselves
+    while (total > budget && index > 0) {
+        total -= list.first().bytes();
+        deleteList(list.first());
+        list.removeFirst();
+        --index;
+    }
+}
+
 HistoryPtrList::HistoryPtrList()
     : d(new Private)
 {
@@ -33,8 +188,7 @@ HistoryPtrList::HistoryPtrList()
 HistoryPtrList::~HistoryPtrList()
 {
     for (int i = d->list.size() - 1; i >= 0; i--) {
-        d->list.at(i)->deleteAll();
-        delete d->list.at(i);
+        Private::deleteList(d->list[i]);
     }
 
     delete d;
@@ -47,33 +201,40 @@ void HistoryPtrList::addItem(EntryList *newItem)
     // If we're currently looking at something prior to the end of the list
     // Remove everything in the list up to this point.
     int currentPosition = d->index + 1;
-    EntryList *temp;
     while (currentPosition < count()) {
-        temp = d->list.takeLast();
-        temp->deleteAll();
-        delete temp;
-    }
-
-    // Now... check to make sure our history isn't 'fat'
-    while (count() >= d->max_size) {
-        temp = d->list.takeFirst();
-        temp->deleteAll();
-        delete temp;
+        Private::deleteList(d->list.last());
+        d->list.removeLast();
     }
     d->index = count() - 1; // Since we have trimmed down to the current position
 
     // One other odd case... if this query is a repeat of the last query
     // replace the current one with the new one
     if (!d->list.empty()) {
-        if (current()->getQuery() == newItem->getQuery()) {
-            temp = d->list.takeLast();
-            temp->deleteAll();
-            delete temp;
+        if (d->list.last().query == newItem->getQuery()) {
+            Private::deleteList(d->list.last());
+            d->list.removeLast();
         }
     }
     // Now add the item
-    d->list.append(newItem);
+    Private::Item item;
+    item.query = newItem->getQuery();
+    item.list = newItem;
+    item.listBytes = Private::estimateBytes(newItem);
+    d->list.append(item);
     d->index = count() - 1;
+
+    // Now... check to make sure our history isn't 'fat'
+    d->enforceBudget();
+}
+
+qint64 HistoryPtrList::byteBudget() const
+{
+    return d->budget;
+}
+
+qint64 HistoryPtrList::bytesUsed() const
+{
+    return d->totalBytes();
 }
 
 int HistoryPtrList::count()
@@ -87,7 +248,13 @@ EntryList *HistoryPtrList::current()
         return nullptr;
     }
 
-    return d->list.at(d->index);
+    Private::Item &item = d->list[d->index];
+    if (!item.list) {
+        d->restore(item);
+        d->enforceBudget();
+    }
+
+    return item.list;
 }
 
 int HistoryPtrList::index()
@@ -113,6 +280,12 @@ void HistoryPtrList::prev(int distance)
     }
 }
 
+void HistoryPtrList::setByteBudget(qint64 bytes)
+{
+    d->budget = bytes;
+    d->enforceBudget();
+}
+
 void HistoryPtrList::setCurrent(int i)
 {
     if (i < count() && i >= 0) {
@@ -120,36 +293,41 @@ void HistoryPtrList::setCurrent(int i)
     }
 }
 
+void HistoryPtrList::setDictionaryManager(const DictionaryManager *manager)
+{
+    d->manager = manager;
+}
+
 // Get a StringList of the History Items
-QStringList HistoryPtrList::toStringList()
+QStringList HistoryPtrList::toStringList() const
 {
     QStringList result;
+    result.reserve(d->list.size());
 
-    for (const EntryList *p : d->list) {
-        result.append(p->getQuery().toString());
+    for (const Private::Item &item : std::as_const(d->list)) {
+        result.append(item.query.toString());
     }
 
     return result;
 }
 
-QStringList HistoryPtrList::toStringListNext()
+QStringList HistoryPtrList::toStringListNext() const
 {
-    HistoryPtrList localCopy(*this);
+    QStringList result;
 
-    int currentPosition = d->index + 1;
-    while (currentPosition--) {
-        localCopy.d->list.removeFirst();
+    for (int i = d->index + 1; i < d->list.size(); i++) {
+        result.append(d->list.at(i).query.toString());
     }
 
-    return localCopy.toStringList();
+    return result;
 }
 
-QStringList HistoryPtrList::toStringListPrev()
+QStringList HistoryPtrList::toStringListPrev() const
 {
     QStringList result;
 
     for (int i = 0; i < d->index; i++) {
-        result.append(d->list.at(i)->getQuery().toString());
+        result.append(d->list.at(i).query.toString());
     }
 
     return result;
@@ -13,8 +13,16 @@
 
 #include "kiten_export.h"
 
+class DictionaryManager;
 class EntryList;
 
+/**
+ * The search history. Only the current item and the most recent ones are kept
+ * as full EntryList objects, older items are reduced to their query and the
+ * handles of their entries (see EntryHandle) and loaded again through the
+ * DictionaryManager when they become current. The history is bounded by a
+ * number of bytes rather than a number of items.
+ */
 class KITEN_EXPORT HistoryPtrList
 {
 public:
@@ -31,20 +39,34 @@ public:
      * the current displayed item.
      */
     void addItem(EntryList *newItem);
+    /**
+     * The manager used to load entries back from their handles. Without
+     * one, items are never reduced to handles.
+     */
+    void setDictionaryManager(const DictionaryManager *manager);
+    /**
+     * The number of bytes the history may use, roughly estimated
+     */
+    qint64 byteBudget() const;
+    void setByteBudget(qint64 bytes);
+    /**
+     * The estimated number of bytes the history uses right now
+     */
+    qint64 bytesUsed() const;
     /**
      * Return a list of the entries. Note that this is usually
      * just a QStringList of all of the EntryList's DictQuery->toString() calls.
      */
-    QStringList toStringList();
+    QStringList toStringList() const;
     /**
      * Return a list of the entries prior to the current one (not including
      * the current entry.
      */
-    QStringList toStringListPrev();
+    QStringList toStringListPrev() const;
     /**
      * Return a summary list that only includes those after the current
      */
-    QStringList toStringListNext();
+    QStringList toStringListNext() const;
     /**
      * Add one to the current location, convenient for 'forward' buttons
      */
@@ -58,11 +80,8 @@ public:
      */
     int index();
     /**
-     * Return the item at the location given by the parameter, and set it
-     * to be the current history list item.
-     */
-    /**
-     * Return the current item
+     * Return the current item, loading its entries back if needed. The
+     * pointer stays valid until the current item changes.
      */
     EntryList *current();
     /**
@@ -75,6 +94,8 @@ public:
     int count();
 
 private:
+    Q_DISABLE_COPY(HistoryPtrList)
+
     class Private;
     Private *const d;
 };
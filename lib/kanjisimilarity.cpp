@@ -0,0 +1,175 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "kanjisimilarity.h"
+
+#include "DictKanjidic/kanjitable.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QStringDecoder>
+
+#include <algorithm>
+#include <cstdlib>
+
+KanjiSimilarity::Pointer KanjiSimilarity::load(const QString &radkfile, const QString &kanjidic)
+{
+    static QMutex lock;
+    static QHash<QString, Pointer> similarities;
+
+    const QDateTime lastModified = QFileInfo(radkfile).lastModified();
+    const QString key = radkfile + u'\n' + kanjidic;
+
+    QMutexLocker locker(&lock);
+    Pointer &similarity = similarities[key];
+    if (similarity && similarity->m_lastModified == lastModified) {
+        return similarity;
+    }
+
+    QSharedPointer<KanjiSimilarity> result(new KanjiSimilarity);
+    result->m_lastModified = lastModified;
+    if (!result->loadRadicals(radkfile)) {
+        similarities.remove(key);
+        return Pointer();
+    }
+    if (!kanjidic.isEmpty()) {
+        result->loadStrokes(kanjidic);
+    }
+
+    similarity = result;
+    return similarity;
+}
+
+bool KanjiSimilarity::loadRadicals(const QString &radkfile)
+{
+    QFile file(radkfile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QStringDecoder decoder("EUC-JP");
+    const QString decoded = decoder(file.readAll());
+
+    // The bit of the current radical, -1 past the last one that fits
+    int radical = -1;
+    int radicalCount = 0;
+    for (QStringView line : QStringView(decoded).split(u'\n')) {
+        line = line.trimmed();
+        if (line.isEmpty() || line.at(0) == u'#') {
+            continue;
+        }
+        if (line.at(0) == u'$') {
+            radical = radicalCount < maxRadicals ? radicalCount : -1;
+            ++radicalCount;
+            continue;
+        }
+        if (radical < 0) {
+            continue;
+        }
+
+        // A list of kanji containing the radical
+        for (QChar kanji : line) {
+            if (kanji.isSpace()) {
+                continue;
+            }
+            int row = m_rows.value(kanji.unicode(), -1);
+            if (row < 0) {
+                row = m_codePoints.size();
+                m_rows.insert(kanji.unicode(), row);
+                m_codePoints.append(kanji.unicode());
+                m_masks.append(RadicalMask{});
+            }
+            m_masks[row].words[radical / 64] |= quint64(1) << (radical % 64);
+        }
+    }
+
+    if (radicalCount > maxRadicals) {
+        qWarning() << radkfile << "has" << radicalCount << "radicals, only the first" << maxRadicals << "are compared";
+    }
+
+    m_radicalCounts.reserve(m_masks.size());
+    for (const RadicalMask &mask : std::as_const(m_masks)) {
+        int count = 0;
+        for (quint64 word : mask.words) {
+            count += qPopulationCount(word);
+        }
+        m_radicalCounts.append(count);
+    }
+    m_strokes = QList<quint8>(m_codePoints.size(), 0);
+
+    return true;
+}
+
+void KanjiSimilarity::loadStrokes(const QString &kanjidic)
+{
+    const KanjiTable::Pointer table = KanjiTable::load(kanjidic);
+    for (int row = 0; table && row < table->size(); ++row) {
+        const int kanji = m_rows.value(table->codePoint(row), -1);
+        if (kanji >= 0) {
+            m_strokes[kanji] = table->strokes(row);
+        }
+    }
+}
+
+QList<KanjiSimilarity::Match> KanjiSimilarity::similarKanji(char32_t kanji, int count, float strokeWeight) const
+{
+    QList<Match> best;
+    const int self = m_rows.value(kanji, -1);
+    if (self < 0 || count <= 0) {
+        return best;
+    }
+
+    const RadicalMask &mask = m_masks.at(self);
+    const int radicals = m_radicalCounts.at(self);
+    const int strokes = m_strokes.at(self);
+
+    // A heap of the best matches so far, with the worst of them on top
+    const auto better = [](const Match &a, const Match &b) {
+        return a.score > b.score;
+    };
+    best.reserve(count + 1);
+
+    for (int row = 0; row < m_masks.size(); ++row) {
+        if (row == self) {
+            continue;
+        }
+
+        const RadicalMask &other = m_masks.at(row);
+        int shared = 0;
+        for (int word = 0; word < maskWords; ++word) {
+            shared += qPopulationCount(mask.words[word] & other.words[word]);
+        }
+        if (shared == 0) {
+            continue;
+        }
+
+        float score = float(shared) / float(radicals + m_radicalCounts.at(row) - shared);
+        if (strokeWeight > 0 && strokes > 0 && m_strokes.at(row) > 0) {
+            score /= 1 + strokeWeight * std::abs(strokes - m_strokes.at(row));
+        }
+
+        if (best.size() < count) {
+            best.append({m_codePoints.at(row), score});
+        } else if (score > best.first().score) {
+            std::pop_heap(best.begin(), best.end(), better);
+            best.last() = {m_codePoints.at(row), score};
+        } else {
+            continue;
+        }
+        std::push_heap(best.begin(), best.end(), better);
+    }
+
+    std::sort_heap(best.begin(), best.end(), better);
+    return best;
+}
+
+int KanjiSimilarity::size() const
+{
+    return m_codePoints.size();
+}
@@ -0,0 +1,85 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KITEN_KANJISIMILARITY_H
+#define KITEN_KANJISIMILARITY_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+
+#include "kiten_export.h"
+
+/**
+ * Finds the kanji that look like a given one, for example to catch OCR
+ * misreads. Two kanji look alike when they are built from the same radicals:
+ * the score is the Jaccard index of their radical sets from radkfile, the
+ * number of shared radicals over the number of radicals in either.
+ *
+ * The radicals of each kanji are kept as a fixed size bitmask, so scoring
+ * every kanji of radkfile takes a few popcounts each.
+ */
+class KITEN_EXPORT KanjiSimilarity
+{
+public:
+    typedef QSharedPointer<const KanjiSimilarity> Pointer;
+
+    struct Match {
+        char32_t kanji;
+        /**
+         * Between 0 and 1, 1 for the same radicals and stroke count
+         */
+        float score;
+    };
+
+    /**
+     * Returns the radical sets of @p radkfile with the stroke counts of
+     * @p kanjidic, parsing them only if this process has not done so yet.
+     * Returns a null pointer if radkfile cannot be read, a missing kanjidic
+     * only leaves out the stroke counts.
+     */
+    static Pointer load(const QString &radkfile, const QString &kanjidic = QString());
+
+    /**
+     * The @p count kanji most similar to @p kanji, best first, not counting
+     * @p kanji itself. With a positive @p strokeWeight each stroke of
+     * difference divides the score by 1 + @p strokeWeight.
+     */
+    QList<Match> similarKanji(char32_t kanji, int count, float strokeWeight = 0) const;
+
+    /**
+     * The number of kanji with radicals
+     */
+    int size() const;
+
+private:
+    /**
+     * Enough for the 253 radicals of radkfile, later ones are ignored
+     */
+    static constexpr int maskWords = 4;
+    static constexpr int maxRadicals = maskWords * 64;
+
+    struct RadicalMask {
+        quint64 words[maskWords];
+    };
+
+    KanjiSimilarity() = default;
+
+    bool loadRadicals(const QString &radkfile);
+    void loadStrokes(const QString &kanjidic);
+
+    QDateTime m_lastModified;
+    QList<char32_t> m_codePoints;
+    QList<RadicalMask> m_masks;
+    QList<quint8> m_radicalCounts;
+    QList<quint8> m_strokes;
+    QHash<char32_t, int> m_rows;
+};
+
+#endif
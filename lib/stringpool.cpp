@@ -0,0 +1,96 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "stringpool.h"
+
+#include <QDebug>
+#include <QHash>
+#include <QList>
+#include <QReadWriteLock>
+
+class StringPool::Private
+{
+public:
+    QReadWriteLock lock;
+    QHash<QString, Atom> atoms;
+    QList<QString> strings;
+};
+
+StringPool::StringPool()
+    : d(new Private)
+{
+    // The empty string always gets atom 0
+    d->atoms.insert(QString(), EmptyAtom);
+    d->strings.append(QString());
+}
+
+StringPool::~StringPool()
+{
+    delete d;
+}
+
+StringPool &StringPool::dictionaries()
+{
+    static StringPool pool;
+    return pool;
+}
+
+StringPool &StringPool::keys()
+{
+    static StringPool pool;
+    return pool;
+}
+
+StringPool::Atom StringPool::intern(const QString &string)
+{
+    if (string.isEmpty()) {
+        return EmptyAtom;
+    }
+
+    {
+        QReadLocker locker(&d->lock);
+        const auto it = d->atoms.constFind(string);
+        if (it != d->atoms.constEnd()) {
+            return it.value();
+        }
+    }
+
+    QWriteLocker locker(&d->lock);
+    // Somebody else may have added it while we were waiting for the lock
+    const auto it = d->atoms.constFind(string);
+    if (it != d->atoms.constEnd()) {
+        return it.value();
+    }
+
+    if (d->strings.size() >= 0xFFFF) {
+        qWarning() << "String pool is full, can not intern" << string;
+        return EmptyAtom;
+    }
+
+    const Atom atom = static_cast<Atom>(d->strings.size());
+    d->strings.append(string);
+    d->atoms.insert(string, atom);
+    return atom;
+}
+
+StringPool::Atom StringPool::find(const QString &string) const
+{
+    QReadLocker locker(&d->lock);
+    return d->atoms.value(string, EmptyAtom);
+}
+
+QString StringPool::string(Atom atom) const
+{
+    QReadLocker locker(&d->lock);
+    return d->strings.value(atom);
+}
+
+int StringPool::count() const
+{
+    QReadLocker locker(&d->lock);
+    return d->strings.size();
+}
@@ -0,0 +1,70 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KITEN_STRINGPOOL_H
+#define KITEN_STRINGPOOL_H
+
+#include <QString>
+
+#include "kiten_export.h"
+
+/**
+ * A process wide table of interned strings. Strings that are repeated in
+ * every Entry (the dictionary name, the extended info keys) are stored once
+ * in a pool and each Entry only keeps the small integer atom for them.
+ *
+ * Atoms are never released, so a pool should only be used for strings
+ * coming from a small, closed set.
+ */
+class KITEN_EXPORT StringPool
+{
+public:
+    typedef quint16 Atom;
+
+    /**
+     * The atom of the empty string. It is also returned by find() for
+     * strings that were never interned.
+     */
+    static constexpr Atom EmptyAtom = 0;
+
+    /**
+     * The pool holding dictionary names. Its atoms are used as dictionary ids.
+     */
+    static StringPool &dictionaries();
+    /**
+     * The pool holding the keys of the extended information of entries.
+     */
+    static StringPool &keys();
+
+    /**
+     * Returns the atom for @p string, adding it to the pool if needed
+     */
+    Atom intern(const QString &string);
+    /**
+     * Returns the atom for @p string, or EmptyAtom if it was never interned.
+     * This never grows the pool, so it is the one to use for lookups.
+     */
+    Atom find(const QString &string) const;
+    /**
+     * Returns the string an atom stands for
+     */
+    QString string(Atom atom) const;
+    /**
+     * Number of strings in the pool, including the empty string
+     */
+    int count() const;
+
+private:
+    StringPool();
+    ~StringPool();
+    Q_DISABLE_COPY(StringPool)
+
+    class Private;
+    Private *const d;
+};
+
+#endif
@@ -45,6 +45,9 @@ void ButtonGrid::buildRadicalButtons()
 
     // Setup the grid
     auto grid = new QGridLayout(this);
+    m_buttons = QList<RadicalButton *>(m_radicalInfo->radicalCount(), nullptr);
+    m_statuses = QList<RadicalButton::ButtonStatus>(m_buttons.size(), RadicalButton::Normal);
+    m_kanjiBits.clear();
 
     // Now make labels
     for (unsigned int i = 0; i < number_of_radical_columns; i++) {
@@ -77,7 +80,10 @@ void ButtonGrid::buildRadicalButtons()
             connect(this, &ButtonGrid::clearButtonSelections, button, &RadicalButton::resetButton);
 
             // Add this button to our list
-            m_buttons.insert(radical.toString(), button);
+            const int number = m_radicalInfo->radicalNumber(radical.toString());
+            if (number >= 0) {
+                m_buttons[number] = button;
+            }
         }
     }
     delete radicalMap;
@@ -98,6 +104,8 @@ void ButtonGrid::clearSelections()
 {
     m_selectedRadicals.clear();
     Q_EMIT clearButtonSelections();
+    m_statuses.fill(RadicalButton::Normal);
+    m_kanjiBits.clear();
 }
 
 void ButtonGrid::radicalClicked(const QString &newrad, RadicalButton::ButtonStatus newStatus)
@@ -120,6 +128,19 @@ void ButtonGrid::radicalClicked(const QString &newrad, RadicalButton::ButtonStat
     }
 }
 
+void ButtonGrid::setButtonStatuses(const QList<RadicalButton::ButtonStatus> &statuses)
+{
+    setUpdatesEnabled(false);
+    for (int radical = 0; radical < statuses.size(); ++radical) {
+        if (statuses.at(radical) != m_statuses.at(radical) && m_buttons.at(radical)) {
+            m_buttons.at(radical)->setStatus(statuses.at(radical));
+        }
+    }
+    setUpdatesEnabled(true);
+
+    m_statuses = statuses;
+}
+
 void ButtonGrid::updateButtons()
 {
     if (!m_radicalInfo) {
@@ -127,45 +148,45 @@ void ButtonGrid::updateButtons()
     }
     // Special Case/Early exit: no radicals selected
     if (m_selectedRadicals.isEmpty()) {
-        QList<Kanji> blankList;
-        for (RadicalButton *button : m_buttons) {
-            button->setStatus(RadicalButton::Normal);
+        if (!m_kanjiBits.isNull()) {
+            m_kanjiBits.clear();
+            Q_EMIT possibleKanji(QList<Kanji>());
         }
-
-        Q_EMIT possibleKanji(blankList);
+        setButtonStatuses(QList<RadicalButton::ButtonStatus>(m_buttons.size(), RadicalButton::Normal));
         return;
     }
 
     // Figure out what our kanji possibilities are
-    QSet<Kanji> kanjiSet = m_radicalInfo->kanjiContainingRadicals(m_selectedRadicals);
+    const QBitArray kanjiBits = m_radicalInfo->kanjiContainingRadicals(m_selectedRadicals);
 
-    // Convert to a list, sort, and tell the world!
-    QList<Kanji> kanjiList = kanjiSet.values();
-    std::sort(kanjiList.begin(), kanjiList.end());
-    Q_EMIT possibleKanji(kanjiList);
+    // Convert to a list, already sorted by strokes, and tell the world!
+    // Unless it did not change
+    if (kanjiBits != m_kanjiBits) {
+        Q_EMIT possibleKanji(m_radicalInfo->kanjiList(kanjiBits));
+        m_kanjiBits = kanjiBits;
+    }
 
     // Do the announcement of the selected radical list
     QStringList radicalList(m_selectedRadicals.values());
     Q_EMIT signalChangeStatusbar(i18n("Selected Radicals: ") + radicalList.join(QLatin1String(", ")));
 
     // Now figure out what our remaining radical possibilities are
-    QSet<QString> remainingRadicals = m_radicalInfo->radicalsInKanji(kanjiSet);
-    // Remove the already selected ones
-    remainingRadicals -= m_selectedRadicals;
-
-    // Now go through and set status appropriately
-    QHash<QString, RadicalButton *>::iterator i = m_buttons.begin();
-    while (i != m_buttons.end()) {
-        if (m_selectedRadicals.contains(i.key())) {
-            i.value()->setStatus(RadicalButton::Selected);
-        } else if (remainingRadicals.contains(i.key())) {
-            i.value()->setStatus(RadicalButton::Normal);
-        } else {
-            i.value()->setStatus(RadicalButton::NotAppropriate);
-        }
+    const QBitArray remainingRadicals = m_radicalInfo->radicalsInKanji(kanjiBits);
 
-        ++i;
+    // Now work out the status of every button, and only touch the ones that change
+    QList<RadicalButton::ButtonStatus> statuses(m_buttons.size(), RadicalButton::NotAppropriate);
+    for (int radical = 0; radical < statuses.size(); ++radical) {
+        if (remainingRadicals.testBit(radical)) {
+            statuses[radical] = RadicalButton::Normal;
+        }
+    }
+    for (const QString &selected : std::as_const(m_selectedRadicals)) {
+        const int radical = m_radicalInfo->radicalNumber(selected);
+        if (radical >= 0 && radical < statuses.size()) {
+            statuses[radical] = RadicalButton::Selected;
+        }
     }
+    setButtonStatuses(statuses);
 }
 
 #include "moc_buttongrid.cpp"
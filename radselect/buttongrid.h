@@ -51,6 +51,11 @@ public Q_SLOTS:
 
 private:
     void buildRadicalButtons();
+    /**
+     * Calls setStatus() on the buttons whose status differs from
+     * m_statuses, with a single repaint for all of them
+     */
+    void setButtonStatuses(const QList<RadicalButton::ButtonStatus> &statuses);
     void updateButtons();
 
     static const unsigned int number_of_radical_columns = 11;
@@ -66,8 +71,12 @@ private:
     RadicalFile *m_radicalInfo;
     bool m_sortByFrequency;
 
-    // Radical -> Button Mapping
-    QHash<QString, RadicalButton *> m_buttons;
+    // Radical number -> Button Mapping
+    QList<RadicalButton *> m_buttons;
+    // The status we last gave to each button
+    QList<RadicalButton::ButtonStatus> m_statuses;
+    // The kanji we last suggested
+    QBitArray m_kanjiBits;
 };
 
 #endif
@@ -12,16 +12,10 @@ Kanji::Kanji()
 {
 }
 
-Kanji::Kanji(const QString &kanji, const QSet<QString> &radicals)
-    : QString(kanji.at(0))
+Kanji::Kanji(const QString &kanji)
+    : QString(kanji)
     , strokeCount(0)
 {
-    components = radicals;
-}
-
-void Kanji::addRadical(const QString &it)
-{
-    components += it;
 }
 
 void Kanji::setStrokes(unsigned int strokes)
@@ -29,11 +23,6 @@ void Kanji::setStrokes(unsigned int strokes)
     strokeCount = strokes;
 }
 
-const QSet<QString> &Kanji::getRadicals() const
-{
-    return components;
-}
-
 unsigned int Kanji::strokes() const
 {
     return strokeCount;
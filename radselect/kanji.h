@@ -8,7 +8,6 @@
 #ifndef KANJI_H
 #define KANJI_H
 
-#include <QSet>
 #include <QString>
 
 #include "radical.h"
@@ -17,18 +16,15 @@ class Kanji : public QString
 {
 public:
     Kanji();
-    explicit Kanji(const QString &kanji, const QSet<QString> &radicals);
+    explicit Kanji(const QString &kanji);
 
-    void addRadical(const QString &it);
     void setStrokes(unsigned int strokes);
-    const QSet<QString> &getRadicals() const;
     unsigned int strokes() const;
 
     bool operator<(const Kanji &other) const;
 
 protected:
     unsigned int strokeCount;
-    QSet<QString> components;
 };
 
 #endif
@@ -11,6 +11,8 @@
 
 Radical::Radical()
     : strokeCount(0)
+    , idx(0)
+    , frequency(0)
 {
 }
 
@@ -18,6 +20,7 @@ Radical::Radical(const QString &irad, unsigned int strokes, unsigned int index)
     : string(irad.at(0))
     , strokeCount(strokes)
     , idx(index)
+    , frequency(0)
 {
 }
 
@@ -26,14 +29,14 @@ QString Radical::toString() const
     return string;
 }
 
-void Radical::addKanji(const QSet<QString> &newKanji)
+unsigned int Radical::kanjiCount() const
 {
-    kanji += newKanji;
+    return frequency;
 }
 
-const QSet<QString> &Radical::getKanji() const
+void Radical::setKanjiCount(unsigned int count)
 {
-    return kanji;
+    frequency = count;
 }
 
 unsigned int Radical::strokes() const
@@ -49,5 +52,5 @@ bool Radical::compareIndices(const Radical &a, const Radical &b)
 bool Radical::compareFrequencies(const Radical &a, const Radical &b)
 {
     // Negative frequency results in a descending order
-    return std::make_tuple(-a.getKanji().size(), a.idx) < std::make_tuple(-b.getKanji().size(), b.idx);
+    return std::make_tuple(-qint64(a.frequency), a.idx) < std::make_tuple(-qint64(b.frequency), b.idx);
 }
@@ -8,7 +8,6 @@
 #ifndef RADICAL_H
 #define RADICAL_H
 
-#include <QSet>
 #include <QString>
 
 class Radical
@@ -19,8 +18,11 @@ public:
 
     QString toString() const;
 
-    const QSet<QString> &getKanji() const;
-    void addKanji(const QSet<QString> &newKanji);
+    /**
+     * The number of kanji containing this radical
+     */
+    unsigned int kanjiCount() const;
+    void setKanjiCount(unsigned int count);
     unsigned int strokes() const;
 
     static bool compareIndices(const Radical &a, const Radical &b);
@@ -30,8 +32,7 @@ protected:
     QString string;
     unsigned int strokeCount;
     unsigned int idx;
-    QSet<QString> kanji;
-    QSet<QString> components;
+    unsigned int frequency;
 };
 
 #endif
@@ -0,0 +1,43 @@
+/*
+    This file is part of Kiten, a KDE Japanese Reference Tool
+    SPDX-FileCopyrightText: 2025 Kiten developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QStringList>
+
+#include "radicalfile.h"
+
+/**
+ * Writes the cache of a radkfile and kanjidic pair, run at build time for
+ * the shipped data files:
+ *
+ * radicalcache radkfile kanjidic output
+ */
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    const QStringList arguments = app.arguments();
+    if (arguments.size() != 4) {
+        qWarning() << "Usage:" << arguments.value(0) << "radkfile kanjidic output";
+        return 1;
+    }
+
+    QString radkfile = arguments.at(1);
+    const QString &kanjidic = arguments.at(2);
+    RadicalFile radicalFile;
+    if (!radicalFile.loadRadicalFile(radkfile) || !radicalFile.loadKanjidic(kanjidic)) {
+        qWarning() << "Could not read" << radkfile << "or" << kanjidic;
+        return 1;
+    }
+
+    if (!radicalFile.saveCache(arguments.at(3), radkfile, kanjidic)) {
+        qWarning() << "Could not write" << arguments.at(3);
+        return 1;
+    }
+
+    return 0;
+}
@@ -6,48 +6,229 @@
 */
 
 #include "radicalfile.h"
-#include "DictKanjidic/dictfilekanjidic.h"
-#include "kitenmacros.h"
+#include "DictKanjidic/kanjitable.h"
 
+#include <QDateTime>
+#include <QDir>
 #include <QFile>
-#include <QRegularExpression>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QString>
 #include <QStringDecoder>
-#include <QTextStream>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
 
 using namespace Qt::StringLiterals;
 
+namespace
+{
+/**
+ * A cache file holds, in host byte order, the header, a record for each
+ * radical and then for each kanji, the bitmap of each radical over the kanji
+ * and the bitmap of each kanji over the radicals, each padded to whole bytes.
+ * A cache written on a machine with the other byte order fails the magic
+ * check and is written again.
+ */
+struct CacheHeader {
+    quint32 magic;
+    quint32 version;
+    qint64 radkfileSize;
+    qint64 radkfileTime;
+    qint64 kanjidicSize;
+    qint64 kanjidicTime;
+    quint32 radicalCount;
+    quint32 kanjiCount;
+};
+
+struct CacheRecord {
+    quint32 codePoint;
+    quint32 strokes;
+};
+
+constexpr quint32 cacheMagic = 0x4b524144; // "KRAD"
+constexpr quint32 cacheVersion = 2;
+
+void sourceInfo(const QString &file, qint64 &size, qint64 &time)
+{
+    const QFileInfo info(file);
+    size = info.exists() ? info.size() : -1;
+    time = info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0;
+}
+
+CacheRecord readRecord(const uchar *&position)
+{
+    CacheRecord record;
+    memcpy(&record, position, sizeof(record));
+    position += sizeof(record);
+    return record;
+}
+
+void writeRecord(QByteArray &data, const QString &character, unsigned int strokes)
+{
+    const CacheRecord record{character.toUcs4().value(0), strokes};
+    data.append(reinterpret_cast<const char *>(&record), sizeof(record));
+}
+
+QString fromCodePoint(char32_t codePoint)
+{
+    return QString::fromUcs4(&codePoint, 1);
+}
+}
+
 RadicalFile::RadicalFile(QString &radkfile, const QString &kanjidic)
 {
+    // The cache installed next to the data files was built from them
+    const QString installedCache = QFileInfo(radkfile).absolutePath() + "/radkfile.cache"_L1;
+    if (loadCache(installedCache, radkfile, kanjidic, false) || loadCache(userCacheFile(), radkfile, kanjidic)) {
+        return;
+    }
+
     loadRadicalFile(radkfile);
     if (!kanjidic.isEmpty()) {
         loadKanjidic(kanjidic);
     }
+    saveCache(userCacheFile(), radkfile, kanjidic);
+}
+
+/**
+ * Calls @p function with the position of every set bit of @p bits,
+ * skipping over empty bytes
+ */
+template<typename Function>
+static void forEachSetBit(const QBitArray &bits, Function function)
+{
+    const auto bytes = reinterpret_cast<const uchar *>(bits.bits());
+    const qsizetype byteCount = (bits.size() + 7) / 8;
+    for (qsizetype i = 0; i < byteCount; ++i) {
+        uint byte = bytes[i];
+        while (byte != 0) {
+            function(int(i * 8 + qCountTrailingZeroBits(byte)));
+            byte &= byte - 1;
+        }
+    }
 }
 
-QSet<Kanji> RadicalFile::kanjiContainingRadicals(QSet<QString> &radicallist) const
+void RadicalFile::buildKanjiRadicals()
 {
-    QSet<QString> kanjiStringSet;
-    QSet<Kanji> result;
+    m_kanjiRadicals = QList<QBitArray>(m_kanji.size(), QBitArray(m_radicals.size()));
+    for (int radical = 0; radical < m_radicalKanji.size(); ++radical) {
+        forEachSetBit(m_radicalKanji.at(radical), [this, radical](int number) {
+            m_kanjiRadicals[number].setBit(radical);
+        });
+    }
+}
+
+QBitArray RadicalFile::kanjiContainingRadicals(const QSet<QString> &radicallist) const
+{
+    QBitArray result(m_kanji.size());
     if (m_radicals.count() < 1 || radicallist.count() < 1) {
         return result;
     }
 
-    // Start out with our first set
-    kanjiStringSet = m_radicals[*radicallist.begin()].getKanji();
-    // Make a set intersection of these m_kanji
+    // Start out with every kanji and AND the bitmap of each radical
+    result.fill(true);
     for (const QString &rad : radicallist) {
-        kanjiStringSet &= m_radicals[rad].getKanji();
+        const int number = radicalNumber(rad);
+        if (number < 0) {
+            result.fill(false);
+            break;
+        }
+        result &= m_radicalKanji.at(number);
     }
 
-    // Convert our set of QString to a set of Kanji
-    for (const QString &kanji : kanjiStringSet) {
-        result += m_kanji[kanji];
-    }
+    return result;
+}
+
+QList<Kanji> RadicalFile::kanjiList(const QBitArray &kanjiBits) const
+{
+    QList<Kanji> result;
+    result.reserve(kanjiBits.count(true));
+    forEachSetBit(kanjiBits, [this, &result](int number) {
+        result.append(m_kanji.at(number));
+    });
 
     return result;
 }
 
+bool RadicalFile::loadCache(const QString &cacheFile, const QString &radkfile, const QString &kanjidic, bool checkTimes)
+{
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < qint64(sizeof(CacheHeader))) {
+        return false;
+    }
+    const uchar *data = file.map(0, file.size());
+    if (data == nullptr) {
+        return false;
+    }
+
+    CacheHeader header;
+    memcpy(&header, data, sizeof(header));
+    qint64 radkfileSize, radkfileTime, kanjidicSize, kanjidicTime;
+    sourceInfo(radkfile, radkfileSize, radkfileTime);
+    sourceInfo(kanjidic, kanjidicSize, kanjidicTime);
+    if (header.magic != cacheMagic || header.version != cacheVersion || header.radkfileSize != radkfileSize
+        || header.kanjidicSize != kanjidicSize) {
+        return false;
+    }
+    if (checkTimes && (header.radkfileTime != radkfileTime || header.kanjidicTime != kanjidicTime)) {
+        return false;
+    }
+
+    const qint64 radicalCount = header.radicalCount;
+    const qint64 kanjiCount = header.kanjiCount;
+    const qint64 kanjiBytes = (kanjiCount + 7) / 8;
+    const qint64 radicalBytes = (radicalCount + 7) / 8;
+    const qint64 expectedSize =
+        sizeof(CacheHeader) + (radicalCount + kanjiCount) * sizeof(CacheRecord) + radicalCount * kanjiBytes + kanjiCount * radicalBytes;
+    if (file.size() != expectedSize) {
+        return false;
+    }
+
+    const uchar *position = data + sizeof(CacheHeader);
+
+    m_radicals.clear();
+    m_radicalNumbers.clear();
+    m_radicals.reserve(radicalCount);
+    m_radicalNumbers.reserve(radicalCount);
+    for (int i = 0; i < radicalCount; ++i) {
+        const CacheRecord record = readRecord(position);
+        m_radicals.append(Radical(fromCodePoint(record.codePoint), record.strokes, i));
+        m_radicalNumbers.insert(m_radicals.last().toString(), i);
+    }
+
+    m_kanji.clear();
+    m_kanjiNumbers.clear();
+    m_kanji.reserve(kanjiCount);
+    m_kanjiNumbers.reserve(kanjiCount);
+    for (int i = 0; i < kanjiCount; ++i) {
+        const CacheRecord record = readRecord(position);
+        Kanji kanji(fromCodePoint(record.codePoint));
+        kanji.setStrokes(record.strokes);
+        m_kanjiNumbers.insert(kanji, i);
+        m_kanji.append(kanji);
+    }
+
+    m_radicalKanji.clear();
+    m_radicalKanji.reserve(radicalCount);
+    for (int i = 0; i < radicalCount; ++i) {
+        m_radicalKanji.append(QBitArray::fromBits(reinterpret_cast<const char *>(position), kanjiCount));
+        m_radicals[i].setKanjiCount(m_radicalKanji.last().count(true));
+        position += kanjiBytes;
+    }
+
+    m_kanjiRadicals.clear();
+    m_kanjiRadicals.reserve(kanjiCount);
+    for (int i = 0; i < kanjiCount; ++i) {
+        m_kanjiRadicals.append(QBitArray::fromBits(reinterpret_cast<const char *>(position), radicalCount));
+        position += radicalBytes;
+    }
+
+    return true;
+}
+
 bool RadicalFile::loadRadicalFile(QString &radkfile)
 {
     QFile f(radkfile);
@@ -58,69 +239,120 @@ bool RadicalFile::loadRadicalFile(QString &radkfile)
     // Read our radical file through a eucJP codec (helpfully builtin to Qt)
     QStringDecoder decoder("EUC-JP");
     const QString decoded = decoder(f.readAll());
-    QTextStream t(decoded.toUtf8());
 
-    Radical *newestRadical = nullptr;
-    QHash<QString, QSet<QString>> krad;
+    m_radicals.clear();
+    m_radicalNumbers.clear();
+
+    // The kanji of each radical, numbered once all of them are known
+    QList<QList<QChar>> radicalKanji;
+    QSet<QChar> allKanji;
+    int current = -1;
 
-    while (!t.atEnd()) {
-        QString line = t.readLine();
-        if (line.length() == 0 || line.at(0) == '#'_L1) {
+    for (QStringView line : QStringView(decoded).split(u'\n')) {
+        line = line.trimmed();
+        if (line.isEmpty() || line.at(0) == u'#') {
             // Skip comment characters
             continue;
-        } else if (line.at(0) == '$'_L1) {
-            // Start of a new radical
-            if (newestRadical != nullptr) {
-                m_radicals.insert(newestRadical->toString(), *newestRadical);
+        } else if (line.at(0) == u'$') {
+            // Start of a new radical: $ radical strokes [image]
+            const QList<QStringView> lineElements = line.split(u' ', Qt::SkipEmptyParts);
+            if (lineElements.size() < 3) {
+                current = -1;
+                continue;
+            }
+            const Radical radical(lineElements.at(1).toString(), lineElements.at(2).toUInt(), m_radicals.size());
+            current = m_radicalNumbers.value(radical.toString(), -1);
+            if (current < 0) {
+                current = m_radicals.size();
+                m_radicalNumbers.insert(radical.toString(), current);
+                m_radicals.append(radical);
+                radicalKanji.append(QList<QChar>());
             }
-            delete newestRadical;
-            QStringList lineElements = line.split(QRegularExpression(QStringLiteral("\\s+")));
-            newestRadical = new Radical(lineElements.at(1), lineElements.at(2).toUInt(), m_radicals.size());
-        } else if (newestRadical != nullptr) {
-            // List of m_kanji, potentially
-            const QList<QString> m_kanjiList = line.trimmed().split(QLatin1String(""), Qt::SkipEmptyParts);
-            const QSet<QString> kanjiSet = QSet<QString>(m_kanjiList.begin(), m_kanjiList.end());
-            newestRadical->addKanji(kanjiSet);
-            for (const QString &kanji : m_kanjiList) {
-                krad[kanji] += newestRadical->toString();
+        } else if (current >= 0) {
+            // List of kanji containing the radical
+            for (QChar kanji : line) {
+                if (!kanji.isSpace()) {
+                    radicalKanji[current].append(kanji);
+                    allKanji.insert(kanji);
+                }
             }
         }
     }
-    if (newestRadical != nullptr) {
-        m_radicals[newestRadical->toString()] = *newestRadical;
-        delete newestRadical;
+    f.close();
+
+    // Kanji are numbered in code point order
+    QList<QChar> kanjiByNumber(allKanji.cbegin(), allKanji.cend());
+    std::sort(kanjiByNumber.begin(), kanjiByNumber.end());
+    m_kanji.clear();
+    m_kanjiNumbers.clear();
+    m_kanji.reserve(kanjiByNumber.size());
+    m_kanjiNumbers.reserve(kanjiByNumber.size());
+    for (QChar kanji : std::as_const(kanjiByNumber)) {
+        m_kanjiNumbers.insert(QString(kanji), m_kanji.size());
+        m_kanji.append(Kanji(QString(kanji)));
     }
 
-    // Move contents of our krad QHash into our hash of m_kanji
-    QHash<QString, QSet<QString>>::iterator it;
-    for (it = krad.begin(); it != krad.end(); ++it) {
-        m_kanji.insert(it.key(), Kanji(it.key(), it.value()));
+    m_radicalKanji = QList<QBitArray>(m_radicals.size(), QBitArray(m_kanji.size()));
+    for (int radical = 0; radical < m_radicals.size(); ++radical) {
+        for (QChar kanji : std::as_const(radicalKanji.at(radical))) {
+            m_radicalKanji[radical].setBit(m_kanjiNumbers.value(QString(kanji)));
+        }
+        m_radicals[radical].setKanjiCount(m_radicalKanji.at(radical).count(true));
     }
-    f.close();
+
+    buildKanjiRadicals();
     return true;
 }
 
-// Mostly copied from KanjiBrowser::loadKanji()
 bool RadicalFile::loadKanjidic(const QString &kanjidic)
 {
-    DictFileKanjidic dictFileKanjidic;
-    dictFileKanjidic.loadSettings();
-    dictFileKanjidic.loadDictionary(kanjidic, KANJIDIC);
+    const KanjiTable::Pointer table = KanjiTable::load(kanjidic);
+    if (!table) {
+        return false;
+    }
 
-    QRegularExpression strokeMatch(QStringLiteral("^S\\d+"));
-    for (const QString &line : dictFileKanjidic.dumpDictionary()) {
-        const QString kanji = line[0];
+    for (int row = 0; row < table->size(); ++row) {
+        const int number = m_kanjiNumbers.value(table->kanji(row), -1);
+        if (number >= 0) {
+            m_kanji[number].setStrokes(table->strokes(row));
+        }
+    }
 
-        QStringList strokesSection = line.split(" "_L1, Qt::SkipEmptyParts).filter(strokeMatch);
+    sortKanjiByStrokes();
+    return true;
+}
 
-        unsigned int strokes = strokesSection.first().remove(0, 1).toInt();
+void RadicalFile::sortKanjiByStrokes()
+{
+    // order[new number] is the old number, the sort keeps the code point
+    // order of kanji with the same number of strokes
+    QList<int> order(m_kanji.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return m_kanji.at(a) < m_kanji.at(b);
+    });
 
-        if (m_kanji.contains(kanji)) {
-            m_kanji[kanji].setStrokes(strokes);
-        }
+    QList<int> numbers(order.size());
+    QList<Kanji> kanji;
+    QList<QBitArray> kanjiRadicals;
+    kanji.reserve(order.size());
+    kanjiRadicals.reserve(order.size());
+    for (int number = 0; number < order.size(); ++number) {
+        numbers[order.at(number)] = number;
+        kanji.append(m_kanji.at(order.at(number)));
+        kanjiRadicals.append(m_kanjiRadicals.at(order.at(number)));
+        m_kanjiNumbers.insert(kanji.last(), number);
     }
+    m_kanji = kanji;
+    m_kanjiRadicals = kanjiRadicals;
 
-    return true;
+    for (QBitArray &bits : m_radicalKanji) {
+        QBitArray renumbered(bits.size());
+        forEachSetBit(bits, [&renumbered, &numbers](int number) {
+            renumbered.setBit(numbers.at(number));
+        });
+        bits = renumbered;
+    }
 }
 
 QMultiMap<int, Radical> *RadicalFile::mapRadicalsByStrokes(int max_strokes) const
@@ -136,12 +368,61 @@ QMultiMap<int, Radical> *RadicalFile::mapRadicalsByStrokes(int max_strokes) cons
     return result;
 }
 
-QSet<QString> RadicalFile::radicalsInKanji(QSet<Kanji> &kanjilist) const
+int RadicalFile::radicalCount() const
 {
-    QSet<QString> possibleRadicals;
-    for (const QString &kanji : kanjilist) {
-        possibleRadicals |= m_kanji[kanji].getRadicals();
-    }
+    return m_radicals.size();
+}
+
+int RadicalFile::radicalNumber(const QString &radical) const
+{
+    return m_radicalNumbers.value(radical, -1);
+}
+
+QBitArray RadicalFile::radicalsInKanji(const QBitArray &kanjiBits) const
+{
+    QBitArray possibleRadicals(m_radicals.size());
+    forEachSetBit(kanjiBits, [this, &possibleRadicals](int number) {
+        possibleRadicals |= m_kanjiRadicals.at(number);
+    });
 
     return possibleRadicals;
 }
+
+bool RadicalFile::saveCache(const QString &cacheFile, const QString &radkfile, const QString &kanjidic) const
+{
+    QDir().mkpath(QFileInfo(cacheFile).absolutePath());
+    QSaveFile file(cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    CacheHeader header;
+    header.magic = cacheMagic;
+    header.version = cacheVersion;
+    sourceInfo(radkfile, header.radkfileSize, header.radkfileTime);
+    sourceInfo(kanjidic, header.kanjidicSize, header.kanjidicTime);
+    header.radicalCount = m_radicals.size();
+    header.kanjiCount = m_kanji.size();
+
+    QByteArray data(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (const Radical &radical : m_radicals) {
+        writeRecord(data, radical.toString(), radical.strokes());
+    }
+    for (const Kanji &kanji : m_kanji) {
+        writeRecord(data, kanji, kanji.strokes());
+    }
+    for (const QBitArray &bits : m_radicalKanji) {
+        data.append(bits.bits(), (bits.size() + 7) / 8);
+    }
+    for (const QBitArray &bits : m_kanjiRadicals) {
+        data.append(bits.bits(), (bits.size() + 7) / 8);
+    }
+
+    file.write(data);
+    return file.commit();
+}
+
+QString RadicalFile::userCacheFile()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/radkfile.cache"_L1;
+}
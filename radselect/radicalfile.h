@@ -8,29 +8,94 @@
 #ifndef RADICALFILE_H
 #define RADICALFILE_H
 
+#include <QBitArray>
 #include <QHash>
+#include <QList>
 #include <QMultiMap>
 #include <QSet>
 #include <QString>
 
 #include "kanji.h"
 #include "radical.h"
-#include "radicalbutton.h"
 
 class RadicalFile
 {
 public:
+    RadicalFile() = default;
+    /**
+     * Loads @p radkfile and the stroke counts of @p kanjidic. A binary cache
+     * is used instead of parsing the files when one is up to date: the one
+     * installed with the data files, or the one of the user's cache
+     * directory, which is written after parsing.
+     */
     explicit RadicalFile(QString &radkfile, const QString &kanjidic = QString());
 
-    QSet<Kanji> kanjiContainingRadicals(QSet<QString> &radicalList) const;
+    /**
+     * The kanji containing every radical of @p radicalList, as a bitmap
+     * over the kanji numbers
+     */
+    QBitArray kanjiContainingRadicals(const QSet<QString> &radicalList) const;
+    /**
+     * The kanji whose bits are set in @p kanjiBits, sorted by their number
+     * of strokes
+     */
+    QList<Kanji> kanjiList(const QBitArray &kanjiBits) const;
+    /**
+     * Reads a cache written by saveCache() for @p radkfile and @p kanjidic.
+     * Fails if the cache is missing, damaged or was written for files of a
+     * different size. With @p checkTimes the modification times of the files
+     * must match as well, installed caches leave it out since installing
+     * does not keep the times.
+     */
+    bool loadCache(const QString &cacheFile, const QString &radkfile, const QString &kanjidic, bool checkTimes = true);
     bool loadRadicalFile(QString &radkfile);
     bool loadKanjidic(const QString &kanjidic);
     QMultiMap<int, Radical> *mapRadicalsByStrokes(int max_strokes = 0) const;
-    QSet<QString> radicalsInKanji(QSet<Kanji> &kanjiList) const;
+    /**
+     * The number of radicals, radical numbers go from 0 to this - 1
+     */
+    int radicalCount() const;
+    /**
+     * The number of @p radical in the bitmaps, or -1 if it is unknown
+     */
+    int radicalNumber(const QString &radical) const;
+    /**
+     * The radicals found in any of the kanji of @p kanjiBits, as a bitmap
+     * over the radical numbers
+     */
+    QBitArray radicalsInKanji(const QBitArray &kanjiBits) const;
+    /**
+     * Writes the loaded radicals, kanji and stroke counts to @p cacheFile,
+     * tagged with the size and time of @p radkfile and @p kanjidic
+     */
+    bool saveCache(const QString &cacheFile, const QString &radkfile, const QString &kanjidic) const;
+
+    /**
+     * The cache of the user's cache directory
+     */
+    static QString userCacheFile();
 
 private:
-    QHash<QString, Kanji> m_kanji;
-    QHash<QString, Radical> m_radicals;
+    void buildKanjiRadicals();
+    void sortKanjiByStrokes();
+
+    /**
+     * Every kanji and radical has a dense number, its index here and its bit
+     * in the bitmaps. Radicals are numbered in file order, kanji by number
+     * of strokes and then code point.
+     */
+    QList<Kanji> m_kanji;
+    QHash<QString, int> m_kanjiNumbers;
+    QList<Radical> m_radicals;
+    QHash<QString, int> m_radicalNumbers;
+    /**
+     * For each radical number, the kanji containing the radical
+     */
+    QList<QBitArray> m_radicalKanji;
+    /**
+     * For each kanji number, the radicals of the kanji
+     */
+    QList<QBitArray> m_kanjiRadicals;
 };
 
 #endif
@@ -24,7 +24,9 @@
 #include <QPushButton>
 #include <QString>
 
-RadSelectView::RadSelectView(QWidget *parent)
+#include <algorithm>
+
+RadSelectView::RadSelectView(QWidget *parent, const QString &kanjidic)
     : QWidget(parent)
 {
     // Setup the ui from the .ui file
@@ -39,7 +41,10 @@ RadSelectView::RadSelectView(QWidget *parent)
                                 "be installed (file kiten/radkfile), this "
                                 "file is required for this app to function."));
     } else {
-        QString kanjidicname = QStandardPaths::locate(QStandardPaths::GenericDataLocation, QStringLiteral("kiten/kanjidic"));
+        QString kanjidicname = kanjidic;
+        if (kanjidicname.isEmpty()) {
+            kanjidicname = QStandardPaths::locate(QStandardPaths::GenericDataLocation, QStringLiteral("kiten/kanjidic"));
+        }
         if (kanjidicname.isNull()) {
             KMessageBox::error(nullptr,
                                i18n("Kanji dictionary does not seem to "
@@ -78,6 +83,7 @@ RadSelectView::RadSelectView(QWidget *parent)
 
     // copy text from copied_line (QLineEdit) to clipboard
     connect(copy_button, &QAbstractButton::clicked, this, &RadSelectView::toClipboard);
+    connect(lookup_button, &QAbstractButton::clicked, this, &RadSelectView::lookUp);
 
     loadSettings();
 }
@@ -127,6 +133,19 @@ void RadSelectView::kanjiDoubleClicked(QListWidgetItem *item)
     copied_line->setCursorPosition(pos + 1);
 }
 
+void RadSelectView::lookUp()
+{
+    // The collected text, or else the kanji last clicked
+    QString text = copied_line->text();
+    if (text.isEmpty() && selected_radicals->currentItem()) {
+        text = selected_radicals->currentItem()->text();
+    }
+
+    if (!text.isEmpty()) {
+        Q_EMIT kanjiSelected(QStringList(text));
+    }
+}
+
 void RadSelectView::listPossibleKanji(const QList<Kanji> &list)
 {
     unsigned int low = strokes_low->value();
@@ -151,12 +170,17 @@ void RadSelectView::listPossibleKanji(const QList<Kanji> &list)
         high = 99;
     }
 
+    // The list is sorted by strokes, the kanji in range are a slice of it
+    const auto first = std::lower_bound(list.cbegin(), list.cend(), low, [](const Kanji &kanji, unsigned int strokes) {
+        return kanji.strokes() < strokes;
+    });
+    const auto last = std::upper_bound(first, list.cend(), high, [](unsigned int strokes, const Kanji &kanji) {
+        return strokes < kanji.strokes();
+    });
+    const QStringList items(first, last);
+
     selected_radicals->clear();
-    for (const Kanji &it : list) {
-        if (low <= it.strokes() && it.strokes() <= high) {
-            new QListWidgetItem((QString)it, selected_radicals);
-        }
-    }
+    selected_radicals->addItems(items);
 
     m_possibleKanji = list;
 
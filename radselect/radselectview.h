@@ -25,7 +25,11 @@ class RadSelectView : public QWidget, public Ui::radical_selector
     Q_OBJECT
 
 public:
-    explicit RadSelectView(QWidget *parent);
+    /**
+     * @param kanjidic the KANJIDIC to take the number of strokes from, the
+     *        installed one if empty
+     */
+    explicit RadSelectView(QWidget *parent, const QString &kanjidic = QString());
     ~RadSelectView() override;
 
     // Load pre-determined search parameters
@@ -36,7 +40,7 @@ Q_SIGNALS:
     void signalChangeStatusbar(const QString &text);
     // Listen for this if you want to detect each minor change
     void searchModified();
-    // This is when they've actually pressed a kanji
+    // This is when they've asked to look up the kanji, with the kanji to look up
     void kanjiSelected(const QStringList &kanjiList);
 
 private Q_SLOTS:
@@ -51,6 +55,8 @@ private Q_SLOTS:
     void kanjiClicked(QListWidgetItem *item);
     // Result is double-clicked
     void kanjiDoubleClicked(QListWidgetItem *item);
+    // Look up button is pressed
+    void lookUp();
     // Sets the list of visible Kanji
     void listPossibleKanji(const QList<Kanji> &list);
     // Copy text from lineedit to clipboard